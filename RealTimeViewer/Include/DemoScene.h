@@ -15,6 +15,8 @@ class FDemoScene
 {
 public:
 	virtual void Init(FCamera &InCamera) {}
+	// false if Init() could not load the assets
+	virtual bool IsLoaded() const { return true; }
 	virtual void DrawScene(FSR_Context& ctx, const glm::mat4x4& InViewMat,float InDeltaSeconds) = 0;
 };
 
@@ -52,6 +54,7 @@ class FDemoScene_Meshes : public FDemoScene
 {
 public:
 	virtual void Init(FCamera& InCamera) override;
+	virtual bool IsLoaded() const override { return _SceneMesh != nullptr; }
 	virtual void DrawScene(FSR_Context& ctx, const glm::mat4x4& InViewMat, float InDeltaSeconds) override;
 
 protected:
@@ -71,6 +74,7 @@ class FDemoScene_Teapot : public FDemoScene
 {
 public:
 	virtual void Init(FCamera& InCamera) override;
+	virtual bool IsLoaded() const override { return _SceneMesh != nullptr; }
 	virtual void DrawScene(FSR_Context& ctx, const glm::mat4x4& InViewMat, float InDeltaSeconds) override;
 
 protected:
@@ -41,7 +41,7 @@ bool FApp::Initialize(const char* InCaption, int32_t InWidth, int32_t InHeight)
 		_DemoScene->Init(_Camera);
 	}
 
-	_SR_Ctx.SetRenderTarget(_Width, _Height, 1, false);
+	_SR_Ctx.SetRenderTarget(_Width, _Height, 1, false, true);
 	_SR_Ctx.SetViewport(0, 0, _Width, _Height);
 	_SR_Ctx.SetCullFaceMode(EFrontFace::FACE_CCW);
 
@@ -193,7 +193,6 @@ void FApp::SwapChain(const FSR_Buffer2D& InBuffer2D)
 {
 	const uint32_t image_width = InBuffer2D.Width();
 	const uint32_t image_height = InBuffer2D.Height();
-	const uint32_t bytes_per_row = InBuffer2D.BytesPerLine();
 
 	assert(image_width == _Width && image_height == _Height);
 	assert(InBuffer2D.Format() == EPixelFormat::PIXEL_FORMAT_RGBA8888);
@@ -201,23 +200,9 @@ void FApp::SwapChain(const FSR_Buffer2D& InBuffer2D)
 	uint8_t* pBuffer = NULL;
 	int32_t pitch = 0;
 	SDL_LockTexture(_SDLRenderTexture, NULL, (void**)&pBuffer, &pitch);
-	assert(bytes_per_row <= pitch);
-
-	if (bytes_per_row == pitch)
-	{
-		memcpy(pBuffer, InBuffer2D.Data(), InBuffer2D.Length());
-	}
-	else
-	{
-		for (uint32_t j = 0; j < image_height; ++j, pBuffer += pitch)
-		{
-			const uint8_t* src = InBuffer2D.GetRowData(j);
-			uint8_t* dst = pBuffer;
-
-			memcpy(dst, src, bytes_per_row);
-		} // end j
-	}
 
+	// the render target is tiled
+	InBuffer2D.Linearize(pBuffer, pitch);
 
 	SDL_UnlockTexture(_SDLRenderTexture);
 }
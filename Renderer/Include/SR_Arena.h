@@ -0,0 +1,55 @@
+// \brief
+//	linear (bump) arena for transient render data.
+//	allocations are released all at once by Reset(), destructors are never called.
+//
+
+#pragma once
+
+#include <vector>
+#include <type_traits>
+#include "SR_Common.h"
+
+
+// size of the first block, the following ones double
+#define SR_ARENA_BLOCK_SIZE		(1 << 20)
+
+// not thread-safe, an arena is used by one thread at a time.
+class FSR_LinearArena
+{
+public:
+	explicit FSR_LinearArena(size_t InBlockSize = SR_ARENA_BLOCK_SIZE);
+
+	void* Allocate(size_t InSize, size_t InAlign);
+
+	// uninitialized storage of InCount elements
+	template <typename T>
+	T* AllocateArray(size_t InCount)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "the arena does not call destructors");
+		return static_cast<T*>(Allocate(sizeof(T) * InCount, alignof(T)));
+	}
+
+	// release all allocations. the blocks are merged into one, so the next frame
+	// of the same load is served from a single block without any malloc.
+	void Reset();
+
+	// bytes handed out since the last Reset()
+	size_t BytesUsed() const { return _used_bytes; }
+	// max of BytesUsed() over the lifetime
+	size_t PeakBytes() const { return _peak_bytes; }
+
+protected:
+	struct FBlock
+	{
+		std::unique_ptr<uint8_t[]>	_data;
+		size_t	_size;
+	};
+
+	std::vector<FBlock>	_blocks;
+	uint32_t	_current; // block being filled
+	size_t		_offset;  // in the current block
+	size_t		_block_size;
+
+	size_t		_used_bytes;
+	size_t		_peak_bytes;
+};
@@ -8,6 +8,20 @@
 #include <vector>
 
 
+// tiled layout: the buffer is stored as (1 << SR_BUFFER_TILE_SHIFT)^2 pixel tiles, row by row inside a tile.
+// a 8x8 tile of 4 bytes pixels is 4 cache lines, the working set of a raster block.
+#define SR_BUFFER_TILE_SHIFT	3
+#define SR_BUFFER_TILE_SIZE		(1 << SR_BUFFER_TILE_SHIFT)
+// swizzled textures: 4x4 texel blocks, a block of RGBA8 texels is one cache line.
+#define SR_TEXTURE_BLOCK_SHIFT	2
+
+// downsample filter of the mip chain
+enum class EMipFilter
+{
+	MIP_FILTER_BOX = 0,	// 2x2 average
+	MIP_FILTER_KAISER	// kaiser windowed sinc, sharper
+};
+
 class FSR_Buffer2D
 {
 public:
@@ -24,16 +38,14 @@ public:
 	// read a element, (cx,cy) is element coordination
 	bool Read(uint32_t cx, uint32_t cy, uint8_t RGBA[]) const 
 	{
-		uint32_t offset = _bytes_per_line * cy;
-		const uint8_t* pData = _buffer.data() + offset;
+		const uint8_t* pData = GetRowData(cy);
 	
 		return Read(pData, cx, RGBA); 
 	}
 
 	bool Read(uint32_t cx, uint32_t cy, uint16_t& Value) const 
 	{
-		uint32_t offset = _bytes_per_line * cy;
-		const uint8_t* pData = _buffer.data() + offset;
+		const uint8_t* pData = GetRowData(cy);
 
 		return Read(pData, cx, Value);
 	}
@@ -41,48 +53,42 @@ public:
 	// maybe normalized [0, 1] before return.
 	bool Read(uint32_t cx, uint32_t cy, float RGBA[]) const 
 	{ 
-		uint32_t offset = _bytes_per_line * cy;
-		const uint8_t* pData = _buffer.data() + offset;
+		const uint8_t* pData = GetRowData(cy);
 
 		return Read(pData, cx, RGBA);
 	}
 
 	bool Read(uint32_t cx, uint32_t cy, float& Value) const 
 	{ 
-		uint32_t offset = _bytes_per_line * cy;
-		const uint8_t* pData = _buffer.data() + offset;
+		const uint8_t* pData = GetRowData(cy);
 
 		return Read(pData, cx, Value);
 	}
 
 	bool Write(uint32_t cx, uint32_t cy, const uint8_t RGBA[]) 
 	{ 
-		uint32_t offset = _bytes_per_line * cy;
-		uint8_t* pData = _buffer.data() + offset;
+		uint8_t* pData = GetRowData(cy);
 
 		return Write(pData, cx, RGBA);
 	}
 
 	bool Write(uint32_t cx, uint32_t cy, uint16_t& Value)
 	{
-		uint32_t offset = _bytes_per_line * cy;
-		uint8_t* pData = _buffer.data() + offset;
+		uint8_t* pData = GetRowData(cy);
 
 		return Write(pData, cx, Value);
 	}
 
 	bool Write(uint32_t cx, uint32_t cy, const float RGBA[])
 	{
-		uint32_t offset = _bytes_per_line * cy;
-		uint8_t* pData = _buffer.data() + offset;
+		uint8_t* pData = GetRowData(cy);
 
 		return Write(pData, cx, RGBA);
 	}
 
 	bool Write(uint32_t cx, uint32_t cy, float Value)
 	{
-		uint32_t offset = _bytes_per_line * cy;
-		uint8_t* pData = _buffer.data() + offset;
+		uint8_t* pData = GetRowData(cy);
 
 		return Write(pData, cx, Value);
 	}
@@ -100,23 +106,62 @@ public:
 	virtual bool Write(uint8_t *pRow, uint32_t cx, float Value) { return false; }
 	virtual void Clear(const float RGBA[]) {}
 
-	// get row pointer
-	uint8_t* GetRowData(uint32_t cy) { return _buffer.data() + (cy * _bytes_per_line); }
-	const uint8_t* GetRowData(uint32_t cy) const { return _buffer.data() + (cy * _bytes_per_line); }
+	// get row pointer, the pixels of a row are addressed by ColumnIndex() from there.
+	uint8_t* GetRowData(uint32_t cy) { return _buffer.data() + GetRowOffset(cy); }
+	const uint8_t* GetRowData(uint32_t cy) const { return _buffer.data() + GetRowOffset(cy); }
+	// bytes between two rows of the linear layout, two rows of tiles of the tiled layout
 	uint32_t BytesPerLine() const { return _bytes_per_line; }
 
+	bool IsTiled() const { return _tile_shift != 0; }
+	// element index of column cx from the row pointer, cx itself for the linear layout
+	inline uint32_t ColumnIndex(uint32_t cx) const
+	{
+		return ((cx >> _tile_shift) << (_tile_shift << 1)) + (cx & _tile_mask);
+	}
+
+	// copy to a linear image with InPitch bytes per row
+	void Linearize(uint8_t* OutData, uint32_t InPitch) const;
+
 	// sample element
 	virtual bool Sample2DNearest(float u, float v, float RGBA[]) const;
 	virtual bool Sample2DLinear(float u, float v, float RGBA[]) const;
 
+	// mip chain, level 0 is this buffer. levels are halved until 1x1.
+	void GenerateMips(EMipFilter InFilter = EMipFilter::MIP_FILTER_BOX);
+	uint32_t MipCount() const { return 1 + static_cast<uint32_t>(_mips.size()); }
+	const FSR_Buffer2D* GetMip(uint32_t InLevel) const { return InLevel == 0 ? this : _mips[InLevel - 1].get(); }
+
+	// level of detail from the uv derivatives along screen x & y
+	float ComputeLod(float dudx, float dvdx, float dudy, float dvdy) const;
+	// sample the nearest mip with nearest filter
+	bool Sample2DNearestMip(float u, float v, float lod, float RGBA[]) const;
+	bool Sample2DNearestMip(float u, float v, const glm::vec2& ddx, const glm::vec2& ddy, float RGBA[]) const
+	{
+		return Sample2DNearestMip(u, v, ComputeLod(ddx.x, ddx.y, ddy.x, ddy.y), RGBA);
+	}
+	// bilinear in the two nearest mips, blended by lod
+	bool Sample2DTrilinear(float u, float v, float lod, float RGBA[]) const;
+	bool Sample2DTrilinear(float u, float v, const glm::vec2& ddx, const glm::vec2& ddy, float RGBA[]) const
+	{
+		return Sample2DTrilinear(u, v, ComputeLod(ddx.x, ddx.y, ddy.x, ddy.y), RGBA);
+	}
+
 protected:
-	FSR_Buffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat);
+	FSR_Buffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat, bool InbTiled);
+	FSR_Buffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat, uint32_t InTileShift);
+
+	// storage of a mip level of this buffer
+	virtual std::shared_ptr<FSR_Buffer2D> CreateMipLevel(uint32_t width, uint32_t height) const;
 
 	inline uint32_t GetElementOffset(uint32_t cx, uint32_t cy) const
 	{
-		return (cx >= _w || cy >= _h) ? SR_INVALID_INDEX : ((_w * cy + cx) * _bytes_per_pixel);
+		return (cx >= _w || cy >= _h) ? SR_INVALID_INDEX : (GetRowOffset(cy) + ColumnIndex(cx) * _bytes_per_pixel);
 	}
 
+	inline uint32_t GetRowOffset(uint32_t cy) const
+	{
+		return ((cy >> _tile_shift) << _tile_shift) * _bytes_per_line + ((cy & _tile_mask) << _tile_shift) * _bytes_per_pixel;
+	}
 	
 
 	static const float ONE_OVER_255;
@@ -127,7 +172,15 @@ protected:
 	uint32_t _bytes_per_line;
 	EPixelFormat _format;
 
+	// 0 for the linear layout, SR_BUFFER_TILE_SHIFT for the tiled one, SR_TEXTURE_BLOCK_SHIFT for swizzled textures
+	uint32_t _tile_shift;
+	uint32_t _tile_mask;
+	// size of the storage, aligned to whole tiles
+	uint32_t _pitch_w, _pitch_h;
+
 	std::vector<uint8_t> _buffer;
+	// levels 1 ... MipCount() - 1, same format & layout
+	std::vector<std::shared_ptr<FSR_Buffer2D>> _mips;
 };
 
 
@@ -139,8 +192,8 @@ using FSR_Texture2D = FSR_Buffer2D;
 class FSR_Buffer2D_U16 : public FSR_Buffer2D
 {
 public:
-	FSR_Buffer2D_U16(uint32_t width, uint32_t height)
-		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_U16)
+	FSR_Buffer2D_U16(uint32_t width, uint32_t height, bool InbTiled = false)
+		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_U16, InbTiled)
 	{}
 
 	// read a element, (cx,cy) is element coordination
@@ -160,8 +213,8 @@ public:
 class FSR_Buffer2D_F32 : public FSR_Buffer2D
 {
 public:
-	FSR_Buffer2D_F32(uint32_t width, uint32_t height)
-		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_F32)
+	FSR_Buffer2D_F32(uint32_t width, uint32_t height, bool InbTiled = false)
+		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_F32, InbTiled)
 	{}
 
 	// read a element, (cx,cy) is element coordination
@@ -181,8 +234,8 @@ public:
 class FSR_Buffer2D_RGB888 : public FSR_Buffer2D
 {
 public:
-	FSR_Buffer2D_RGB888(uint32_t width, uint32_t height)
-		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGB888)
+	FSR_Buffer2D_RGB888(uint32_t width, uint32_t height, bool InbTiled = false)
+		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGB888, InbTiled)
 	{}
 
 	// read a element, (cx,cy) is element coordination
@@ -202,10 +255,17 @@ public:
 class FSR_Buffer2D_RGBA8888 : public FSR_Buffer2D
 {
 public:
-	FSR_Buffer2D_RGBA8888(uint32_t width, uint32_t height)
-		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGBA8888)
+	FSR_Buffer2D_RGBA8888(uint32_t width, uint32_t height, bool InbTiled = false)
+		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGBA8888, InbTiled)
+	{}
+
+protected:
+	FSR_Buffer2D_RGBA8888(uint32_t width, uint32_t height, uint32_t InTileShift)
+		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGBA8888, InTileShift)
 	{}
 
+public:
+
 	// read a element, (cx,cy) is element coordination
 	virtual bool Read(const uint8_t *pRow, uint32_t cx, uint8_t RGBA[]) const override;
 	virtual bool Read(const uint8_t *pRow, uint32_t cx, uint16_t& Value) const override;
@@ -223,8 +283,8 @@ public:
 class FSR_Buffer2D_RGBF32 : public FSR_Buffer2D
 {
 public:
-	FSR_Buffer2D_RGBF32(uint32_t width, uint32_t height)
-		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGBF32)
+	FSR_Buffer2D_RGBF32(uint32_t width, uint32_t height, bool InbTiled = false)
+		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGBF32, InbTiled)
 	{}
 
 	// read a element, (cx,cy) is element coordination
@@ -244,8 +304,8 @@ public:
 class FSR_Buffer2D_RGBAF32 : public FSR_Buffer2D
 {
 public:
-	FSR_Buffer2D_RGBAF32(uint32_t width, uint32_t height)
-		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGBAF32)
+	FSR_Buffer2D_RGBAF32(uint32_t width, uint32_t height, bool InbTiled = false)
+		: FSR_DepthBuffer(width, height, EPixelFormat::PIXEL_FORMAT_RGBAF32, InbTiled)
 	{}
 
 	// read a element, (cx,cy) is element coordination
@@ -262,15 +322,36 @@ public:
 	virtual void Clear(const float RGBA[]) override;
 };
 
+// sampled texture: RGBA8 texels in 4x4 blocks, power-of-two sizes so the block index is a shift.
+// filled once when loaded, the bilinear taps are fetched & unpacked in SSE registers.
+class FSR_Texture2D_Swizzled : public FSR_Buffer2D_RGBA8888
+{
+public:
+	FSR_Texture2D_Swizzled(uint32_t width, uint32_t height)
+		: FSR_Buffer2D_RGBA8888(width, height, uint32_t(SR_TEXTURE_BLOCK_SHIFT))
+	{
+		assert(IsPowerOfTwo(width) && IsPowerOfTwo(height));
+	}
+
+	static bool IsPowerOfTwo(uint32_t x) { return x && !(x & (x - 1)); }
+
+	virtual bool Sample2DNearest(float u, float v, float RGBA[]) const override;
+	virtual bool Sample2DLinear(float u, float v, float RGBA[]) const override;
+
+protected:
+	virtual std::shared_ptr<FSR_Buffer2D> CreateMipLevel(uint32_t width, uint32_t height) const override;
+};
+
 
 // Helper Class
 class FSR_Buffer2D_Helper
 {
 public:
-	static std::shared_ptr<FSR_Buffer2D> CreateBuffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat);
+	static std::shared_ptr<FSR_Buffer2D> CreateBuffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat, bool InbTiled = false);
 
 	// load & save
-	static std::shared_ptr<FSR_Buffer2D> LoadImageFile(const char* InFileName);
+	// the mip chain is generated on the job system, from the dispatching thread.
+	static std::shared_ptr<FSR_Buffer2D> LoadImageFile(const char* InFileName, EMipFilter InMipFilter = EMipFilter::MIP_FILTER_BOX);
 	static bool SaveImageFile(const std::shared_ptr<FSR_Buffer2D> InTexture, const char* InFileName);
 
 };
\ No newline at end of file
@@ -9,6 +9,9 @@
 #include <cassert>
 #include <memory>
 #include <algorithm>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #define GLM_FORCE_INLINE
 #define GLM_FORCE_INTRINSICS
@@ -18,10 +21,36 @@
 
 
 #define SR_ENABLE_PERFORMACE_STAT	0
+// scoped trace events of frames, draws & jobs (see SR_Trace.h)
+#define SR_ENABLE_TRACE				0
+// overdraw, depth complexity & tile load heatmaps of the frame (see SR_DebugHeatmap.h)
+#define SR_ENABLE_DEBUG_HEATMAPS	0
 
 #define SR_INVALID_INDEX		(-1)
 #define SR_ARRAY_COUNT(a)		(sizeof(a) / sizeof(a[0]))
 
+// index of the lowest set bit, InValue must not be 0
+inline uint32_t CountTrailingZeros(uint32_t InValue)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, InValue);
+	return index;
+#else
+	return __builtin_ctz(InValue);
+#endif
+}
+
+// number of set bits
+inline uint32_t CountBits(uint32_t InValue)
+{
+#if defined(_MSC_VER)
+	return __popcnt(InValue);
+#else
+	return __builtin_popcount(InValue);
+#endif
+}
+
 
 // target or texture format
 enum class EPixelFormat
@@ -48,6 +77,30 @@ enum class EFrontFace
 	FACE_CCW
 };
 
+// DEPTH TEST, pass if (incoming depth) FUNC (stored depth)
+enum class ECompareFunc
+{
+	COMPARE_NEVER = 0,
+	COMPARE_LESS,
+	COMPARE_EQUAL,
+	COMPARE_LESS_EQUAL,
+	COMPARE_GREATER,
+	COMPARE_NOT_EQUAL,
+	COMPARE_GREATER_EQUAL,
+	COMPARE_ALWAYS
+};
+
+// COLOR WRITE MASK, channels written to the color targets
+enum EColorWriteMask
+{
+	COLOR_WRITE_NONE = 0,
+	COLOR_WRITE_R	= 0x01,
+	COLOR_WRITE_G	= 0x02,
+	COLOR_WRITE_B	= 0x04,
+	COLOR_WRITE_A	= 0x08,
+	COLOR_WRITE_ALL = 0x0F
+};
+
 // rectangle
 struct FSR_Rectangle
 {
@@ -125,6 +178,22 @@ struct FSRPixelShaderOutput
 	uint32_t	_color_cnt;
 };
 
+// PS QUAD INPUT, 2x2 pixels: (x, y), (x + 1, y), (x, y + 1), (x + 1, y + 1)
+struct FSRPixelShaderQuadInput
+{
+	FSRPixelShaderInput	_pixels[4];
+	// screen-space derivatives of the attributes, shared by the quad (only if the shader UseDerivatives())
+	FSRVertexAttributes	_ddx, _ddy;
+	// pixels to output, the others are helper pixels which only feed the derivatives
+	uint32_t			_mask;
+};
+
+// PS QUAD OUTPUT
+struct FSRPixelShaderQuadOutput
+{
+	FSRPixelShaderOutput	_pixels[4];
+};
+
 // MVP MATRIXS GROUP
 class FMVPMatrixs
 {
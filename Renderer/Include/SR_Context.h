@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <vector>
 #include "SR_Common.h"
 #include "SR_Buffer2D.h"
 #include "SR_Shader.h"
@@ -14,6 +15,12 @@
 #define MSAA_SAMPLES		4
 #define MAX_CLIP_VTXCOUNT	9
 
+class FSR_TileBins;
+class FSR_TileScheduler;
+class FSR_HiZBuffer;
+class FSR_LinearArena;
+class FSR_DebugHeatmaps;
+
 // render context
 class FSR_Context
 {
@@ -21,13 +28,22 @@ public:
 	FSR_Context();
 	virtual ~FSR_Context();
 
-	void EnableMultiThreads();
-	// set render target
-	void SetRenderTarget(uint32_t w, uint32_t h, uint32_t nCount, bool InbEnableMSAA = false);
+	void EnableMultiThreads(uint32_t InNumThreads = 0);
+	// set render target, tiled targets keep the pixels of a raster block together (see FSR_Buffer2D::Linearize)
+	void SetRenderTarget(uint32_t w, uint32_t h, uint32_t nCount, bool InbEnableMSAA = false, bool InbTiled = false);
 	// clear render target
 	void ClearRenderTarget(const glm::vec4& InColor);
 	// set cull face mode
 	void SetCullFaceMode(EFrontFace InMode);
+
+	// depth & color output state, default: LESS_EQUAL, depth write on, all channels.
+	void SetDepthFunc(ECompareFunc InFunc);
+	void SetDepthWrite(bool InbEnable);
+	void SetColorWriteMask(uint32_t InMask);
+
+	// size range in pixels of the tile raster jobs, default: [SR_TILE_JOB_MIN_SIZE, SR_TILE_JOB_MAX_SIZE].
+	// with multi-threads, tiles are split down to InMinSize or merged up to InMaxSize by their cost in the last frame.
+	void SetTileSizeRange(uint32_t InMinSize, uint32_t InMaxSize);
 	
 	// set viewport
 	void SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
@@ -80,9 +96,10 @@ public:
 	FMVPMatrixs		_mvps;
 
 	EFrontFace	_front_face;
-	// clip vertex buffer
-	FSRVertexShaderOutput	_clip_vtx_buffer0[MAX_CLIP_VTXCOUNT];
-	FSRVertexShaderOutput	_clip_vtx_buffer1[MAX_CLIP_VTXCOUNT];
+
+	ECompareFunc	_depth_func;
+	bool			_bDepthWrite;
+	uint32_t		_color_write_mask; // EColorWriteMask
 
 	std::shared_ptr<FSR_DepthBuffer>	_rt_depth;
 	std::shared_ptr<FSR_Texture2D>		_rt_colors[MAX_MRT_COUNT];
@@ -97,11 +114,29 @@ public:
 	std::shared_ptr<FSR_PixelShader>	_ps;
 
 	std::shared_ptr<FSR_Performance>	_stats;
+	// tile rasterizer counters per thread slot, merged into _stats at EndFrame
+	std::vector<FSR_WorkerStats>		_worker_stats;
+	double		_frame_start_microseconds; // with SR_ENABLE_PERFORMACE_STAT or SR_ENABLE_TRACE
+	double		_frame_start_busy_microseconds;
+
+	// post-transform vertices of the current DrawMesh, reset per draw
+	std::shared_ptr<FSR_LinearArena>	_vertex_arena;
+
+	// triangles waiting for the tile rasterizer
+	std::shared_ptr<FSR_TileBins>		_tile_bins;
+	// partition of the tiles into raster jobs
+	std::shared_ptr<FSR_TileScheduler>	_tile_scheduler;
+	// max depth pyramid of _rt_depth
+	std::shared_ptr<FSR_HiZBuffer>		_hiz;
+	// counters of the frame, with SR_ENABLE_DEBUG_HEATMAPS
+	std::shared_ptr<FSR_DebugHeatmaps>	_heatmaps;
 
 	// shadow pointer of aboves
 	struct FPointersShadow {
 		FSR_DepthBuffer* _rt_depth;
 		FSR_Texture2D*	 _rt_colors[MAX_MRT_COUNT];
+		FSR_HiZBuffer*	 _hiz;
+		FSR_DebugHeatmaps* _heatmaps;
 
 		FSR_DepthBuffer*	_rt_depth_msaa;
 		FSR_Texture2D*		_rt_colors_msaa[MAX_MRT_COUNT];
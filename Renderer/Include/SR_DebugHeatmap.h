@@ -0,0 +1,65 @@
+// \brief
+//	debug heatmaps of the tile rasterizer: overdraw, depth complexity & tile load.
+//	filled when SR_ENABLE_DEBUG_HEATMAPS, saved as color-mapped images.
+//
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include "SR_Common.h"
+#include "SR_Buffer2D.h"
+
+
+enum class EDebugHeatmap
+{
+	HEATMAP_OVERDRAW = 0,		// pixel shader runs per pixel
+	HEATMAP_DEPTH_COMPLEXITY,	// depth tests per pixel (samples with msaa)
+	HEATMAP_DEPTH_FAIL,			// failed depth tests per pixel
+	HEATMAP_TILE_LOAD,			// rasterizer cycles per tile
+
+	HEATMAP_COUNT
+};
+
+// per-frame counters, a pixel is only touched by the job of its tile
+class FSR_DebugHeatmaps
+{
+public:
+	FSR_DebugHeatmaps(uint32_t w, uint32_t h);
+
+	void Clear();
+
+	void AddDepthTest(int32_t x, int32_t y, bool InbPassed)
+	{
+		FPixelCounters& pixel = _pixels[y * _w + x];
+		++pixel._depth_tests;
+		pixel._depth_fails += InbPassed ? 0 : 1;
+	}
+
+	void AddShaded(int32_t x, int32_t y)
+	{
+		++_pixels[y * _w + x]._shaded;
+	}
+
+	// cycles of a tile job covering [X0, X1) x [Y0, Y1), summed over the flushes of the frame
+	void AddTileCycles(int32_t X0, int32_t Y0, int32_t X1, int32_t Y1, uint64_t InCycles);
+
+	// color-mapped image, black is no work and red is OutMaxValue (the max of the frame)
+	std::shared_ptr<FSR_Buffer2D> CreateImage(EDebugHeatmap InKind, double* OutMaxValue = nullptr) const;
+	// <InPrefix>_overdraw.png, _depth_complexity.png, _depth_fail.png & _tile_load.png
+	bool SaveImages(const char* InPrefix) const;
+
+protected:
+	double GetValue(EDebugHeatmap InKind, uint32_t InIndex) const;
+
+	struct FPixelCounters
+	{
+		uint32_t	_shaded;
+		uint32_t	_depth_tests;
+		uint32_t	_depth_fails;
+		uint64_t	_tile_cycles; // of the pixel's tile
+	};
+
+	int32_t _w, _h;
+	std::vector<FPixelCounters>	_pixels;
+};
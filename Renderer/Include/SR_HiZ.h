@@ -0,0 +1,84 @@
+// \brief
+//	hierarchical z-buffer: conservative max depth of the 8x8 blocks and 64x64 cells of the depth target.
+//	a block max is raised at once by a farther write, and lowered when all pixels of the block have been rewritten.
+//
+
+#pragma once
+
+#include <vector>
+#include "SR_Common.h"
+
+
+// block size, the rasterizer updates & tests depth at this granularity
+#define SR_HIZ_BLOCK_SIZE		8
+// coarse cell size, for whole triangles
+#define SR_HIZ_CELL_SIZE		64
+// slack of the depth tests, covers the rounding of the interpolated depth
+#define SR_HIZ_DEPTH_BIAS		1e-5f
+
+static_assert(SR_HIZ_BLOCK_SIZE * SR_HIZ_BLOCK_SIZE == 64, "a 64-bit mask tracks the written pixels of a block");
+
+class FSR_HiZBuffer
+{
+public:
+	FSR_HiZBuffer(uint32_t w, uint32_t h);
+
+	// reset to the cleared depth
+	void Clear(float InDepth);
+
+	// max depth of the block containing pixel (x, y)
+	float GetBlockMaxDepth(int32_t x, int32_t y) const
+	{
+		return _blocks[(y / SR_HIZ_BLOCK_SIZE) * _blocks_x + (x / SR_HIZ_BLOCK_SIZE)]._max;
+	}
+
+	// pixels InMask (bit 8 * row + column) of the block containing pixel (x, y) now hold depth <= InMaxDepth.
+	// return true if the block max has changed.
+	bool AccumulateBlock(int32_t x, int32_t y, uint64_t InMask, float InMaxDepth)
+	{
+		FBlock& block = _blocks[(y / SR_HIZ_BLOCK_SIZE) * _blocks_x + (x / SR_HIZ_BLOCK_SIZE)];
+		block._mask |= InMask;
+		block._pending_max = std::max(block._pending_max, InMaxDepth);
+
+		bool bChanged = false;
+		if (InMaxDepth > block._max)
+		{
+			block._max = InMaxDepth;
+			bChanged = true;
+		}
+		// all pixels rewritten since the last reset
+		if (block._mask == ~0ull)
+		{
+			if (block._pending_max < block._max)
+			{
+				block._max = block._pending_max;
+				bChanged = true;
+			}
+			ResetBlock(block, x / SR_HIZ_BLOCK_SIZE, y / SR_HIZ_BLOCK_SIZE);
+		}
+		return bChanged;
+	}
+
+	// max depth over the cells overlapped by [X0, X1) x [Y0, Y1)
+	float GetMaxDepth(int32_t X0, int32_t Y0, int32_t X1, int32_t Y1) const;
+	// refresh the cells of [X0, X1) x [Y0, Y1) from their blocks, the cells must be owned by the caller.
+	void UpdateCells(int32_t X0, int32_t Y0, int32_t X1, int32_t Y1);
+
+protected:
+	struct FBlock
+	{
+		float		_max;
+		float		_pending_max; // of the pixels written since the last reset
+		uint64_t	_mask;		  // pixels written since the last reset, pixels outside the frame are set
+	};
+
+	void ResetBlock(FBlock& OutBlock, int32_t InBlockX, int32_t InBlockY) const;
+
+protected:
+	int32_t _w, _h;
+	int32_t _blocks_x, _blocks_y;
+	int32_t _cells_x, _cells_y;
+
+	std::vector<FBlock>	_blocks;
+	std::vector<float>	_cells;
+};
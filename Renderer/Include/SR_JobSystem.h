@@ -0,0 +1,142 @@
+// \brief
+//	work-stealing job system.
+//	every worker owns a lock-free job ring, idle workers steal from the others.
+//
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "SR_Common.h"
+
+
+#define SR_CACHE_LINE_SIZE	64
+// jobs per worker ring, power of 2
+#define SR_JOB_RING_SIZE	1024
+// fetch attempts before a thread parks
+#define SR_JOB_SPIN_COUNT	256
+
+typedef void (*pfnSRJob)(void* InData, uint32_t InIndex);
+
+struct FSR_Job
+{
+	pfnSRJob	_func;
+	void*		_data;
+	uint32_t	_index;
+};
+
+// bounded ring, one producer (the dispatching thread) & many consumers (owner and thieves).
+class FSR_JobRing
+{
+public:
+	FSR_JobRing() : _head(0), _tail(0), _tail_local(0) {}
+
+	// producer: stage a job, invisible to consumers until Publish()
+	bool Stage(const FSR_Job& InJob)
+	{
+		if (_tail_local - _head.load(std::memory_order_acquire) >= SR_JOB_RING_SIZE)
+		{
+			return false;
+		}
+		_jobs[_tail_local & (SR_JOB_RING_SIZE - 1)] = InJob;
+		++_tail_local;
+		return true;
+	}
+
+	// producer: make all staged jobs visible at once
+	uint32_t Publish()
+	{
+		const uint32_t count = _tail_local - _tail.load(std::memory_order_relaxed);
+		_tail.store(_tail_local, std::memory_order_release);
+		return count;
+	}
+
+	// consumers
+	bool Pop(FSR_Job& OutJob)
+	{
+		uint32_t head = _head.load(std::memory_order_acquire);
+		while (1)
+		{
+			const uint32_t tail = _tail.load(std::memory_order_acquire);
+			if (head == tail)
+			{
+				return false;
+			}
+			// a stale copy is dropped when the CAS fails
+			OutJob = _jobs[head & (SR_JOB_RING_SIZE - 1)];
+			if (_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				return true;
+			}
+		}
+	}
+
+protected:
+	alignas(SR_CACHE_LINE_SIZE) std::atomic<uint32_t> _head;
+	alignas(SR_CACHE_LINE_SIZE) std::atomic<uint32_t> _tail;
+	uint32_t _tail_local;
+	alignas(SR_CACHE_LINE_SIZE) FSR_Job	_jobs[SR_JOB_RING_SIZE];
+};
+
+class FSR_JobSystem
+{
+public:
+	static FSR_JobSystem& sharedInstance();
+
+	// start workers, 0 means one thread per hardware thread counting the caller (at least 1 worker).
+	bool Start(uint32_t InNumWorkers = 0);
+	void Terminate();
+
+	bool IsRunning() const { return !_workers.empty(); }
+	uint32_t NumWorkers() const { return static_cast<uint32_t>(_workers.size()); }
+
+	// slot of the calling thread for per-thread data: worker k is k + 1, any other thread 0.
+	static uint32_t ThreadSlot();
+	uint32_t NumThreadSlots() const { return NumWorkers() + 1; }
+	// time spent in jobs by the workers since Start(), when SR_ENABLE_PERFORMACE_STAT.
+	// only consistent between ParallelFor() calls of the dispatching thread.
+	double WorkersBusyMicroseconds() const;
+
+	// queue jobs InFunc(InData, 0) ... InFunc(InData, InCount - 1), must be called from one thread.
+	void Dispatch(pfnSRJob InFunc, void* InData, uint32_t InCount);
+	// fence: wait until all dispatched jobs are done, the calling thread runs jobs meanwhile.
+	void Wait();
+	// dispatch & wait, runs on the calling thread if the system is not started.
+	void ParallelFor(pfnSRJob InFunc, void* InData, uint32_t InCount);
+
+public:
+	FSR_JobSystem();
+	~FSR_JobSystem();
+
+protected:
+	void WorkerLoop(uint32_t InWorkerIndex);
+	// pop from own ring, or steal from others
+	bool FetchJob(uint32_t InWorkerIndex, FSR_Job& OutJob);
+	void Execute(const FSR_Job& InJob);
+
+protected:
+	std::vector<std::thread>	_workers;
+	std::vector<std::unique_ptr<FSR_JobRing>>	_rings;
+
+	// written by its own thread only, padded against false sharing
+	struct alignas(SR_CACHE_LINE_SIZE) FSlotTimes
+	{
+		double	_busy_microseconds;
+	};
+	std::vector<FSlotTimes>		_slot_times;
+	uint32_t	_next_ring;
+
+	alignas(SR_CACHE_LINE_SIZE) std::atomic<int32_t>	_queued;  // jobs in rings
+	alignas(SR_CACHE_LINE_SIZE) std::atomic<int32_t>	_pending; // jobs not finished
+	std::atomic<int32_t>	_sleepers; // parked workers
+	std::atomic<bool>		_waiting;  // dispatching thread parked in Wait()
+	bool	_terminate;
+
+	std::mutex	_wake_mutex;
+	std::condition_variable _wake_cv;
+	std::mutex	_done_mutex;
+	std::condition_variable _done_cv;
+};
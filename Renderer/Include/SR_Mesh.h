@@ -22,6 +22,11 @@ public:
 	bool LoadFromObjFile(const char* fileName, const char* mtlBaseDir);
 	void Purge();
 
+	// rebuild SoA position streams from _VertexBuffer
+	void BuildPositionStreams();
+	// the streams hold the positions of _VertexBuffer, O(n) for debug checks
+	bool PositionStreamsMatch() const;
+
 public:
 	struct FSR_SubMesh
 	{
@@ -33,11 +38,15 @@ public:
 		uint32_t	_MaterialIndex = SR_INVALID_INDEX;
 	};
 
+	// call BuildPositionStreams() after changing the positions, DrawMesh() shades from the streams
 	std::vector<FSRVertex>	_VertexBuffer;
 	std::vector<uint32_t>	_IndexBuffer;
 	std::vector<std::shared_ptr<FSR_Material>>	_Materials;
 
 	std::vector<FSR_SubMesh>	_SubMeshes;
+
+	// x, y, z, w of vertices for batched vertex shading
+	std::vector<float>	_PositionStreams[4];
 };
 
 
@@ -1,17 +1,27 @@
 // \brief
-//		Time Query On Windows Platform.
+//		Time Query & Performance Statistic.
 //
 
 #pragma once
 
 #include <stdint.h> // uint32_t
 #include <iostream>
+#include <algorithm>
 
+// time with the invariant tsc on x86 outside of windows, calibrated at startup;
+// falls back to clock_gettime(CLOCK_MONOTONIC_RAW) when the tsc is not invariant.
+#if !defined(SR_TIMING_USE_RDTSC)
+#if !defined(_WIN32) && (defined(__x86_64__) || defined(__i386__))
+#define SR_TIMING_USE_RDTSC		1
+#else
+#define SR_TIMING_USE_RDTSC		0
+#endif
+#endif
 
 double appInitTiming();
 double appSeconds();
 double appMicroSeconds();
-int64_t appCycles();
+int64_t appCycles(); // raw ticks of the timing backend
 
 class FPerformanceCounter
 {
@@ -36,6 +46,37 @@ private:
 };
 
 
+// counters of the tile rasterizer, one block per thread (see FSR_JobSystem::ThreadSlot),
+// padded to a cache line so that workers never write the same line. merged at EndFrame.
+struct alignas(64) FSR_WorkerStats
+{
+	FSR_WorkerStats()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		_pixels_tested = 0;
+		_pixels_passed = 0;
+		_pixels_shaded = 0;
+		_ps_invoke_count = 0;
+		_color_write_count = 0;
+		_quads_culled = 0;
+		_tiles_processed = 0;
+		_tile_total_microseconds = 0;
+	}
+
+	uint64_t	_pixels_tested;  // depth tests of covered pixels (samples with msaa)
+	uint64_t	_pixels_passed;
+	uint64_t	_pixels_shaded;  // active lanes of the pixel shader
+	uint64_t	_ps_invoke_count; // ProcessWide calls
+	uint64_t	_color_write_count;
+	uint64_t	_quads_culled;   // covered 2x2 quads without any depth-passed pixel
+	uint64_t	_tiles_processed; // tiles with binned triangles
+	double		_tile_total_microseconds;
+};
+
 // soft-raster performance statistic
 class FSR_Performance
 {
@@ -63,6 +104,89 @@ public:
 		_depth_total_microseconds = 0;
 		_color_write_count = 0;
 		_color_total_microseconds = 0;
+		_bin_arena_peak_bytes = 0;
+		_vertex_arena_peak_bytes = 0;
+		_pixels_tested = 0;
+		_pixels_shaded = 0;
+		_quads_culled = 0;
+		_tiles_processed = 0;
+		_tile_total_microseconds = 0;
+		_worker_busy_microseconds = 0;
+		_worker_idle_microseconds = 0;
+	}
+
+	// add counters of another (e.g. per-job) stats
+	void Accumulate(const FSR_Performance& InOther)
+	{
+		_triangles_count += InOther._triangles_count;
+		_vertexes_count += InOther._vertexes_count;
+		_vs_invoke_count += InOther._vs_invoke_count;
+		_vs_total_microseconds += InOther._vs_total_microseconds;
+		_check_inside_frustum_count += InOther._check_inside_frustum_count;
+		_check_inside_frustum_microseconds += InOther._check_inside_frustum_microseconds;
+		_clip_invoke_count += InOther._clip_invoke_count;
+		_clip_total_microseconds += InOther._clip_total_microseconds;
+		_raster_invoked_count += InOther._raster_invoked_count;
+		_raster_total_microseconds += InOther._raster_total_microseconds;
+		_ps_invoke_count += InOther._ps_invoke_count;
+		_ps_total_microseconds += InOther._ps_total_microseconds;
+		_depth_tw_count += InOther._depth_tw_count;
+		_depth_total_microseconds += InOther._depth_total_microseconds;
+		_color_write_count += InOther._color_write_count;
+		_color_total_microseconds += InOther._color_total_microseconds;
+		_bin_arena_peak_bytes = std::max(_bin_arena_peak_bytes, InOther._bin_arena_peak_bytes);
+		_vertex_arena_peak_bytes = std::max(_vertex_arena_peak_bytes, InOther._vertex_arena_peak_bytes);
+		_pixels_tested += InOther._pixels_tested;
+		_pixels_shaded += InOther._pixels_shaded;
+		_quads_culled += InOther._quads_culled;
+		_tiles_processed += InOther._tiles_processed;
+		_tile_total_microseconds += InOther._tile_total_microseconds;
+		_worker_busy_microseconds += InOther._worker_busy_microseconds;
+		_worker_idle_microseconds += InOther._worker_idle_microseconds;
+	}
+
+	// add the counters of a rasterizer thread
+	void Accumulate(const FSR_WorkerStats& InWorker)
+	{
+		_ps_invoke_count += static_cast<uint32_t>(InWorker._ps_invoke_count);
+		_depth_tw_count += static_cast<uint32_t>(InWorker._pixels_passed);
+		_color_write_count += static_cast<uint32_t>(InWorker._color_write_count);
+		_pixels_tested += InWorker._pixels_tested;
+		_pixels_shaded += InWorker._pixels_shaded;
+		_quads_culled += InWorker._quads_culled;
+		_tiles_processed += InWorker._tiles_processed;
+		_tile_total_microseconds += InWorker._tile_total_microseconds;
+	}
+
+	// visit the counters by name, e.g. for machine readable reports
+	template<typename FVisitor>
+	void ForEachStat(FVisitor&& InVisitor) const
+	{
+		InVisitor("triangles_count", double(_triangles_count));
+		InVisitor("vertexes_count", double(_vertexes_count));
+		InVisitor("vs_invoke_count", double(_vs_invoke_count));
+		InVisitor("vs_total_microseconds", _vs_total_microseconds);
+		InVisitor("check_inside_frustum_count", double(_check_inside_frustum_count));
+		InVisitor("check_inside_frustum_microseconds", _check_inside_frustum_microseconds);
+		InVisitor("clip_invoke_count", double(_clip_invoke_count));
+		InVisitor("clip_total_microseconds", _clip_total_microseconds);
+		InVisitor("raster_invoked_count", double(_raster_invoked_count));
+		InVisitor("raster_total_microseconds", _raster_total_microseconds);
+		InVisitor("ps_invoke_count", double(_ps_invoke_count));
+		InVisitor("ps_total_microseconds", _ps_total_microseconds);
+		InVisitor("depth_tw_count", double(_depth_tw_count));
+		InVisitor("depth_total_microseconds", _depth_total_microseconds);
+		InVisitor("color_write_count", double(_color_write_count));
+		InVisitor("color_total_microseconds", _color_total_microseconds);
+		InVisitor("bin_arena_peak_bytes", double(_bin_arena_peak_bytes));
+		InVisitor("vertex_arena_peak_bytes", double(_vertex_arena_peak_bytes));
+		InVisitor("pixels_tested", double(_pixels_tested));
+		InVisitor("pixels_shaded", double(_pixels_shaded));
+		InVisitor("quads_culled", double(_quads_culled));
+		InVisitor("tiles_processed", double(_tiles_processed));
+		InVisitor("tile_total_microseconds", _tile_total_microseconds);
+		InVisitor("worker_busy_microseconds", _worker_busy_microseconds);
+		InVisitor("worker_idle_microseconds", _worker_idle_microseconds);
 	}
 
 	void DisplayStats(std::ostream& output)
@@ -84,7 +208,16 @@ public:
 			"_depth_tw_count = " << _depth_tw_count << std::endl <<
 			"_depth_total_microseconds = " << _depth_total_microseconds << std::endl <<
 			"_color_write_count = " << _color_write_count << std::endl <<
-			"_color_total_microseconds = " << _color_total_microseconds << std::endl;
+			"_color_total_microseconds = " << _color_total_microseconds << std::endl <<
+			"_bin_arena_peak_bytes = " << _bin_arena_peak_bytes << std::endl <<
+			"_vertex_arena_peak_bytes = " << _vertex_arena_peak_bytes << std::endl <<
+			"_pixels_tested = " << _pixels_tested << std::endl <<
+			"_pixels_shaded = " << _pixels_shaded << std::endl <<
+			"_quads_culled = " << _quads_culled << std::endl <<
+			"_tiles_processed = " << _tiles_processed << std::endl <<
+			"_tile_total_microseconds = " << _tile_total_microseconds << std::endl <<
+			"_worker_busy_microseconds = " << _worker_busy_microseconds << std::endl <<
+			"_worker_idle_microseconds = " << _worker_idle_microseconds << std::endl;
 	}
 
 public:
@@ -112,4 +245,19 @@ public:
 
 	uint32_t	_color_write_count;
 	double		_color_total_microseconds;
+
+	// peak usage of the transient arenas
+	uint64_t	_bin_arena_peak_bytes;
+	uint64_t	_vertex_arena_peak_bytes;
+
+	// tile rasterizer, merged from FSR_WorkerStats
+	uint64_t	_pixels_tested;
+	uint64_t	_pixels_shaded;
+	uint64_t	_quads_culled;
+	uint64_t	_tiles_processed;
+	double		_tile_total_microseconds; // summed over the threads
+
+	// job system workers over the frame
+	double		_worker_busy_microseconds;
+	double		_worker_idle_microseconds;
 };
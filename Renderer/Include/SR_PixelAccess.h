@@ -0,0 +1,86 @@
+// \brief
+//	typed pixel access for the raster hot path.
+//	the format is a template argument, reads & writes of known formats inline without virtual calls.
+//	PIXEL_FORMAT_MAX stands for any format, through the virtual interface of FSR_Buffer2D.
+//
+
+#pragma once
+
+#include "SR_Buffer2D.h"
+#include "SR_SSE.h"
+
+
+template <EPixelFormat Format>
+struct TSR_PixelAccess
+{
+	static inline float ReadDepth(const FSR_Buffer2D* InBuffer, const uint8_t* pRow, uint32_t cx)
+	{
+		float Value = 0.f;
+		InBuffer->Read(pRow, cx, Value);
+		return Value;
+	}
+
+	static inline void WriteDepth(FSR_Buffer2D* InBuffer, uint8_t* pRow, uint32_t cx, float InValue)
+	{
+		InBuffer->Write(pRow, cx, InValue);
+	}
+
+	static inline void ReadColor(const FSR_Buffer2D* InBuffer, const uint8_t* pRow, uint32_t cx, float RGBA[])
+	{
+		InBuffer->Read(pRow, cx, RGBA);
+	}
+
+	static inline void WriteColor(FSR_Buffer2D* InBuffer, uint8_t* pRow, uint32_t cx, const float RGBA[])
+	{
+		InBuffer->Write(pRow, cx, RGBA);
+	}
+};
+
+// depth
+template <>
+struct TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_F32>
+{
+	static inline float ReadDepth(const FSR_Buffer2D* InBuffer, const uint8_t* pRow, uint32_t cx)
+	{
+		return reinterpret_cast<const float*>(pRow)[InBuffer->ColumnIndex(cx)];
+	}
+
+	static inline void WriteDepth(FSR_Buffer2D* InBuffer, uint8_t* pRow, uint32_t cx, float InValue)
+	{
+		reinterpret_cast<float*>(pRow)[InBuffer->ColumnIndex(cx)] = InValue;
+	}
+};
+
+// color, normalized [0, 1]
+template <>
+struct TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_RGBA8888>
+{
+	static inline void ReadColor(const FSR_Buffer2D* InBuffer, const uint8_t* pRow, uint32_t cx, float RGBA[])
+	{
+		const uint8_t* pData = pRow + (InBuffer->ColumnIndex(cx) << 2);
+		VectorRegister clr0 = VectorLoadByte4(pData);
+		VectorRegister clr1 = VectorMultiply(clr0, VectorRegsiterConstants::FloatOneOver255);
+		VectorStore(clr1, RGBA);
+	}
+
+	static inline void WriteColor(FSR_Buffer2D* InBuffer, uint8_t* pRow, uint32_t cx, const float RGBA[])
+	{
+		VectorRegister clr0 = VectorLoad(RGBA);
+		VectorRegister clr1 = VectorMultiply(clr0, VectorRegsiterConstants::Float255);
+		VectorStoreByte4(clr1, pRow + (InBuffer->ColumnIndex(cx) << 2));
+	}
+};
+
+template <>
+struct TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_RGBAF32>
+{
+	static inline void ReadColor(const FSR_Buffer2D* InBuffer, const uint8_t* pRow, uint32_t cx, float RGBA[])
+	{
+		VectorStore(VectorLoad(pRow + (InBuffer->ColumnIndex(cx) << 4)), RGBA);
+	}
+
+	static inline void WriteColor(FSR_Buffer2D* InBuffer, uint8_t* pRow, uint32_t cx, const float RGBA[])
+	{
+		VectorStore(VectorLoad(RGBA), pRow + (InBuffer->ColumnIndex(cx) << 4));
+	}
+};
@@ -18,9 +18,11 @@ public:
 
 	// draw a mesh
 	// NOTE: this function will modify context's material.
+	// NOTE: vertices are shaded once per draw, the vertex shader must not depend on the material.
 	static void DrawMesh(FSR_Context& InContext, const FSR_Mesh &InMesh);
 
-	static bool EnableMultiThreads();
+	// start the job system, 0 threads means one per hardware thread.
+	static bool EnableMultiThreads(uint32_t InNumThreads = 0);
 
 	// Flush
 	static void Flush(FSR_Context& InContext);
@@ -0,0 +1,165 @@
+// \brief
+//	wide SIMD registers for SoA code: 8 lanes with AVX2, 4 lanes with SSE.
+//
+
+#pragma once
+
+#include <cstdint>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+
+#if defined(__AVX2__)
+
+#define SR_SIMD_WIDTH	8
+
+typedef __m256	VectorRegisterWide;
+typedef __m256i VectorRegisterWideInt;
+
+#define WideZero()					_mm256_setzero_ps()
+#define WideSet1(F)					_mm256_set1_ps(F)
+#define WideLoad(Ptr)				_mm256_loadu_ps((const float*)(Ptr))
+#define WideStore(Vec, Ptr)			_mm256_storeu_ps((float*)(Ptr), Vec)
+#define WideAdd(A, B)				_mm256_add_ps(A, B)
+#define WideSubtract(A, B)			_mm256_sub_ps(A, B)
+#define WideMultiply(A, B)			_mm256_mul_ps(A, B)
+#define WideDivide(A, B)			_mm256_div_ps(A, B)
+#define WideMin(A, B)				_mm256_min_ps(A, B)
+#define WideMax(A, B)				_mm256_max_ps(A, B)
+#define WideCompareGT(A, B)			_mm256_cmp_ps(A, B, _CMP_GT_OQ)
+#define WideCompareGE(A, B)			_mm256_cmp_ps(A, B, _CMP_GE_OQ)
+#define WideMoveMask(A)				_mm256_movemask_ps(A)
+#define WideSqrt(A)					_mm256_sqrt_ps(A)
+#define WideAnd(A, B)				_mm256_and_ps(A, B)
+// Mask ? A : B, per lane
+#define WideSelect(Mask, A, B)		_mm256_blendv_ps(B, A, Mask)
+// (0, 1, 2, ... SR_SIMD_WIDTH - 1)
+#define WideLaneIndices()			_mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f)
+#if defined(__FMA__)
+#define WideMultiplyAdd(A, B, C)	_mm256_fmadd_ps(A, B, C)
+#else
+#define WideMultiplyAdd(A, B, C)	_mm256_add_ps(_mm256_mul_ps(A, B), C)
+#endif
+
+#define WideIntSet1(I)				_mm256_set1_epi32(I)
+#define WideIntAdd(A, B)			_mm256_add_epi32(A, B)
+#define WideIntCompareGT(A, B)		_mm256_cmpgt_epi32(A, B)
+#define WideIntMoveMask(A)			_mm256_movemask_ps(_mm256_castsi256_ps(A))
+// (0, I, 2 * I, ... (SR_SIMD_WIDTH - 1) * I)
+#define WideIntRamp(I)				_mm256_setr_epi32(0, (I), 2 * (I), 3 * (I), 4 * (I), 5 * (I), 6 * (I), 7 * (I))
+#define WideIntSubtract(A, B)		_mm256_sub_epi32(A, B)
+#define WideIntAnd(A, B)			_mm256_and_si256(A, B)
+#define WideIntOr(A, B)				_mm256_or_si256(A, B)
+#define WideIntShiftLeft(A, N)		_mm256_slli_epi32(A, N)
+#define WideIntShiftRight(A, N)		_mm256_srli_epi32(A, N)
+// conversions & reinterpretations between float and int32 lanes
+#define WideIntToFloat(A)			_mm256_cvtepi32_ps(A)
+#define WideFloatToIntRound(A)		_mm256_cvtps_epi32(A)
+#define WideCastToInt(A)			_mm256_castps_si256(A)
+#define WideCastToFloat(A)			_mm256_castsi256_ps(A)
+
+#else
+
+#define SR_SIMD_WIDTH	4
+
+typedef __m128	VectorRegisterWide;
+typedef __m128i VectorRegisterWideInt;
+
+#define WideZero()					_mm_setzero_ps()
+#define WideSet1(F)					_mm_set1_ps(F)
+#define WideLoad(Ptr)				_mm_loadu_ps((const float*)(Ptr))
+#define WideStore(Vec, Ptr)			_mm_storeu_ps((float*)(Ptr), Vec)
+#define WideAdd(A, B)				_mm_add_ps(A, B)
+#define WideSubtract(A, B)			_mm_sub_ps(A, B)
+#define WideMultiply(A, B)			_mm_mul_ps(A, B)
+#define WideDivide(A, B)			_mm_div_ps(A, B)
+#define WideMin(A, B)				_mm_min_ps(A, B)
+#define WideMax(A, B)				_mm_max_ps(A, B)
+#define WideCompareGT(A, B)			_mm_cmpgt_ps(A, B)
+#define WideCompareGE(A, B)			_mm_cmpge_ps(A, B)
+#define WideMoveMask(A)				_mm_movemask_ps(A)
+#define WideSqrt(A)					_mm_sqrt_ps(A)
+#define WideAnd(A, B)				_mm_and_ps(A, B)
+// Mask ? A : B, per lane
+#define WideSelect(Mask, A, B)		_mm_or_ps(_mm_and_ps(Mask, A), _mm_andnot_ps(Mask, B))
+// (0, 1, 2, ... SR_SIMD_WIDTH - 1)
+#define WideLaneIndices()			_mm_setr_ps(0.f, 1.f, 2.f, 3.f)
+#define WideMultiplyAdd(A, B, C)	_mm_add_ps(_mm_mul_ps(A, B), C)
+
+#define WideIntSet1(I)				_mm_set1_epi32(I)
+#define WideIntAdd(A, B)			_mm_add_epi32(A, B)
+#define WideIntCompareGT(A, B)		_mm_cmpgt_epi32(A, B)
+#define WideIntMoveMask(A)			_mm_movemask_ps(_mm_castsi128_ps(A))
+// (0, I, 2 * I, ... (SR_SIMD_WIDTH - 1) * I)
+#define WideIntRamp(I)				_mm_setr_epi32(0, (I), 2 * (I), 3 * (I))
+#define WideIntSubtract(A, B)		_mm_sub_epi32(A, B)
+#define WideIntAnd(A, B)			_mm_and_si128(A, B)
+#define WideIntOr(A, B)				_mm_or_si128(A, B)
+#define WideIntShiftLeft(A, N)		_mm_slli_epi32(A, N)
+#define WideIntShiftRight(A, N)		_mm_srli_epi32(A, N)
+// conversions & reinterpretations between float and int32 lanes
+#define WideIntToFloat(A)			_mm_cvtepi32_ps(A)
+#define WideFloatToIntRound(A)		_mm_cvtps_epi32(A)
+#define WideCastToInt(A)			_mm_castps_si128(A)
+#define WideCastToFloat(A)			_mm_castsi128_ps(A)
+
+#endif
+
+
+// log2(x) for x > 0 (normal floats), relative error about 1e-7.
+// x = m * 2^e with m in [sqrt(1/2), sqrt(2)), log(m) = 2 * atanh((m - 1) / (m + 1)) as an odd series.
+inline VectorRegisterWide WideLog2(VectorRegisterWide X)
+{
+	const VectorRegisterWideInt Bits = WideCastToInt(X);
+	VectorRegisterWideInt Exponent = WideIntSubtract(WideIntShiftRight(Bits, 23), WideIntSet1(127));
+	VectorRegisterWide M = WideCastToFloat(WideIntOr(WideIntAnd(Bits, WideIntSet1(0x007FFFFF)), WideIntSet1(0x3F800000)));
+
+	const VectorRegisterWide Above = WideCompareGT(M, WideSet1(1.41421356f));
+	M = WideSelect(Above, WideMultiply(M, WideSet1(0.5f)), M);
+	VectorRegisterWide E = WideAdd(WideIntToFloat(Exponent), WideAnd(Above, WideSet1(1.f)));
+
+	const VectorRegisterWide T = WideDivide(WideSubtract(M, WideSet1(1.f)), WideAdd(M, WideSet1(1.f)));
+	const VectorRegisterWide T2 = WideMultiply(T, T);
+	VectorRegisterWide P = WideSet1(1.f / 9.f);
+	P = WideMultiplyAdd(P, T2, WideSet1(1.f / 7.f));
+	P = WideMultiplyAdd(P, T2, WideSet1(1.f / 5.f));
+	P = WideMultiplyAdd(P, T2, WideSet1(1.f / 3.f));
+	P = WideMultiplyAdd(P, T2, WideSet1(1.f));
+
+	// 2 / ln(2)
+	return WideMultiplyAdd(WideMultiply(P, T), WideSet1(2.88539008f), E);
+}
+
+// 2^x, x is clamped to the normal range [-126, 127], relative error about 2e-7.
+inline VectorRegisterWide WideExp2(VectorRegisterWide X)
+{
+	X = WideMin(WideMax(X, WideSet1(-126.f)), WideSet1(127.f));
+
+	// x = n + f, f in [-0.5, 0.5]
+	const VectorRegisterWideInt N = WideFloatToIntRound(X);
+	const VectorRegisterWide F = WideSubtract(X, WideIntToFloat(N));
+
+	// cephes exp2f polynomial
+	VectorRegisterWide P = WideSet1(1.535336188319500e-4f);
+	P = WideMultiplyAdd(P, F, WideSet1(1.339887440266574e-3f));
+	P = WideMultiplyAdd(P, F, WideSet1(9.618437357674640e-3f));
+	P = WideMultiplyAdd(P, F, WideSet1(5.550332471162809e-2f));
+	P = WideMultiplyAdd(P, F, WideSet1(2.402264791363012e-1f));
+	P = WideMultiplyAdd(P, F, WideSet1(6.931472028550421e-1f));
+	P = WideMultiplyAdd(P, F, WideSet1(1.f));
+
+	// * 2^n
+	const VectorRegisterWide Scale = WideCastToFloat(WideIntShiftLeft(WideIntAdd(N, WideIntSet1(127)), 23));
+	return WideMultiply(P, Scale);
+}
+
+// x^y, 0 for x <= 0
+inline VectorRegisterWide WidePow(VectorRegisterWide X, VectorRegisterWide Y)
+{
+	const VectorRegisterWide Positive = WideCompareGT(X, WideZero());
+	const VectorRegisterWide R = WideExp2(WideMultiply(Y, WideLog2(WideMax(X, WideSet1(1.17549435e-38f)))));
+	return WideAnd(Positive, R);
+}
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "SR_Common.h"
+#include "SR_SIMD.h"
 
 
 class FSR_Context;
@@ -16,6 +17,32 @@ struct FSRPixelShaderContext
 	class FSR_Material* _material;
 };
 
+// VS INPUT BATCH, positions are also given as SoA streams
+struct FSRVertexShaderBatch
+{
+	const FSRVertexShaderInput*	_inputs;
+	const float*	_positions[4]; // x, y, z, w streams, null if not available
+	uint32_t		_count;
+};
+
+// PS WIDE INPUT, SR_SIMD_WIDTH pixels in SoA: SR_SIMD_WIDTH / 4 quads side by side, lane (4 * q + i) is pixel i of quad q.
+struct FSRPixelShaderWideInput
+{
+	// component c of attribute k, lane l: _attributes[k][c][l]
+	alignas(32) float	_attributes[MAX_ATTRIBUTES_COUNT][4][SR_SIMD_WIDTH];
+	uint32_t			_count;
+	// lanes to output, the others are helper pixels
+	uint32_t			_mask;
+};
+
+// PS WIDE OUTPUT
+struct FSRPixelShaderWideOutput
+{
+	// component c of color k, lane l: _colors[k][c][l]
+	alignas(32) float	_colors[MAX_MRT_COUNT][4][SR_SIMD_WIDTH];
+	uint32_t			_color_cnt;
+};
+
 // vs shader
 class FSR_VertexShader
 {
@@ -24,6 +51,8 @@ public:
 
 	virtual void Process(const FSR_Context& InContext, const FSRVertexShaderInput& Input, FSRVertexShaderOutput& Output) = 0;
 
+	// shade a batch of vertices, the default calls Process() per vertex.
+	virtual void ProcessBatch(const FSR_Context& InContext, const FSRVertexShaderBatch& Input, FSRVertexShaderOutput* Output);
 };
 
 // ps shader
@@ -34,6 +63,14 @@ public:
 
 	virtual void Process(const FSRPixelShaderContext& InContext, const FSRPixelShaderInput &Input, FSRPixelShaderOutput &Output) = 0;
 	virtual uint32_t OutputColorCount() { return 1; }
+
+	// shade SR_SIMD_WIDTH pixels at once, only the lanes of Input._mask need an output.
+	// the default splits them into quads for ProcessQuad().
+	virtual void ProcessWide(const FSRPixelShaderContext& InContext, const FSRPixelShaderWideInput& Input, FSRPixelShaderWideOutput& Output);
+	// shade a 2x2 quad, only the pixels of Input._mask need an output. the default calls Process() per pixel.
+	virtual void ProcessQuad(const FSRPixelShaderContext& InContext, const FSRPixelShaderQuadInput& Input, FSRPixelShaderQuadOutput& Output);
+	// the quad derivatives are used, the default ProcessWide() fills the helper pixels & _ddx, _ddy.
+	virtual bool UseDerivatives() { return false; }
 };
 
 
@@ -48,6 +85,7 @@ class FSR_SimplePixelShader : public FSR_PixelShader
 {
 public:
 	virtual void Process(const FSRPixelShaderContext& InContext, const FSRPixelShaderInput& Input, FSRPixelShaderOutput& Output) override;
+	virtual void ProcessWide(const FSRPixelShaderContext& InContext, const FSRPixelShaderWideInput& Input, FSRPixelShaderWideOutput& Output) override;
 	virtual uint32_t OutputColorCount() override { return 1; }
 };
 
@@ -56,6 +94,7 @@ class FSR_DepthOnlyVertexShader : public FSR_VertexShader
 {
 public:
 	virtual void Process(const FSR_Context& InContext, const FSRVertexShaderInput& Input, FSRVertexShaderOutput& Output) override;
+	virtual void ProcessBatch(const FSR_Context& InContext, const FSRVertexShaderBatch& Input, FSRVertexShaderOutput* Output) override;
 };
 
 class FSR_DepthOnlyPixelShader : public FSR_PixelShader
@@ -70,11 +109,16 @@ class FSR_SimpleMeshVertexShader : public FSR_VertexShader
 {
 public:
 	virtual void Process(const FSR_Context& InContext, const FSRVertexShaderInput& Input, FSRVertexShaderOutput& Output) override;
+	virtual void ProcessBatch(const FSR_Context& InContext, const FSRVertexShaderBatch& Input, FSRVertexShaderOutput* Output) override;
 };
 
+// ProcessWide() & ProcessQuad() sample the mip of the quad derivatives, Process() has none and samples the base level.
 class FSR_SimpleMeshPixelShader : public FSR_PixelShader
 {
 public:
 	virtual void Process(const FSRPixelShaderContext& InContext, const FSRPixelShaderInput& Input, FSRPixelShaderOutput& Output) override;
+	virtual void ProcessWide(const FSRPixelShaderContext& InContext, const FSRPixelShaderWideInput& Input, FSRPixelShaderWideOutput& Output) override;
+	virtual void ProcessQuad(const FSRPixelShaderContext& InContext, const FSRPixelShaderQuadInput& Input, FSRPixelShaderQuadOutput& Output) override;
+	virtual bool UseDerivatives() override { return true; }
 	virtual uint32_t OutputColorCount() override { return 1; }
 };
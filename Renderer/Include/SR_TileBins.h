@@ -0,0 +1,186 @@
+// \brief
+//	sort-middle binning: the triangles of a frame are sorted into screen tiles,
+//  each tile is rasterized once when the context is flushed.
+//
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include "SR_Common.h"
+#include "SR_Context.h"
+#include "SR_Arena.h"
+
+
+// tile size in pixels, fixed & independent of the worker count. the raster jobs split or merge tiles, see FSR_TileScheduler
+#define SR_TILE_SIZE	64
+// sub-pixel precision of the rasterizer, screen positions are snapped to 16.8 fixed point
+#define SR_SUBPIXEL_BITS	8
+#define SR_SUBPIXEL_ONE		(1 << SR_SUBPIXEL_BITS)
+// triangles per block of a tile's list
+#define SR_BIN_BLOCK_SIZE	64
+
+// https://www.scratchapixel.com/lessons/3d-basic-rendering/rasterization-practical-implementation/rasterization-stage
+// https://www.scratchapixel.com/lessons/3d-basic-rendering/rasterization-practical-implementation/visibility-problem-depth-buffer-depth-interpolation
+// https://www.scratchapixel.com/lessons/3d-basic-rendering/rasterization-practical-implementation/perspective-correct-interpolation-vertex-attributes
+struct FSR_RasterizedVert
+{
+	glm::vec3	_ndc_pos;
+	glm::vec3	_screen_pos;
+	float		_inv_w;
+};
+
+// pipeline state shared by all triangles of a draw
+struct FSR_DrawState
+{
+	const FSR_Context* _SRCtx;
+	FSR_Context::FPointersShadow _Pointers;
+	FSRPixelShaderContext _psCtx;
+	bool	_bEnableMSAA;
+
+	// output merger
+	ECompareFunc	_depth_func;
+	bool			_bDepthWrite;
+	uint32_t		_color_write_mask;
+	bool			_bDepthOnly; // no color output, skip attributes & pixel shader
+	bool			_bTypedTargets; // F32 depth & RGBA8888 colors, rasterized with inlined pixel access
+
+	bool	_bEnableHiZ; // block & triangle occlusion culling with _Pointers._hiz
+	bool	_bUpdateHiZ; // depth writes are tracked by _Pointers._hiz
+	bool	_bBinCullHiZ; // whole triangles are culled at binning, against the HiZ of earlier flushes
+
+	// hold references until the bins are flushed
+	std::shared_ptr<FSR_PixelShader>	_ps;
+	std::shared_ptr<FSR_Material>		_material;
+};
+
+// a triangle after setup, waiting for the tile rasterizer. the record is shared by all overlapped tiles,
+// its size depends on the attribute count (see Size()), copy it with memcpy.
+struct alignas(16) FTiledRenderingContext
+{
+	const FSR_DrawState* _DrawState;
+
+	/* edges 12, 20, 01 in sub-pixel units: E(P) = A * P.x + B * P.y + C, P is covered if E(P) + bias >= 0 */
+	int64_t _EdgeA[3], _EdgeB[3], _EdgeC[3];
+	int32_t _EdgeBias[3]; // top-left rule, 0 or -1
+
+	/* bounding box in pixels */
+	int32_t _X0, _Y0, _X1, _Y1;
+
+	/* vertices in edge order: screen depth */
+	float _kOneOverE012;
+	float _Z[3];
+	float _MinZ;
+
+	/* screen-space planes of the pixel center (_X0, _Y0): value, d/dx, d/dy */
+	float _InvWPlane[3]; // 1/w
+	/* the planes of the attributes / w follow the record, none for depth-only draws */
+	uint32_t _AttributeCount;
+
+	// [value, d/dx, d/dy] of attribute k
+	const glm::vec4* AttributePlane(uint32_t k) const { return reinterpret_cast<const glm::vec4*>(this + 1) + k * 3; }
+	glm::vec4* AttributePlane(uint32_t k) { return reinterpret_cast<glm::vec4*>(this + 1) + k * 3; }
+	size_t Size() const { return sizeof(FTiledRenderingContext) + sizeof(glm::vec4) * 3 * _AttributeCount; }
+};
+
+// a record with room for all attributes, to set up a triangle
+struct FTiledRenderingContextStorage
+{
+	FTiledRenderingContext	_setup;
+	glm::vec4				_attributes[3 * MAX_ATTRIBUTES_COUNT];
+};
+
+// the triangle list of a tile is a chain of blocks in the frame arena
+struct FSR_BinBlock
+{
+	FSR_BinBlock*	_next;
+	uint32_t		_count;
+	const FTiledRenderingContext* _triangles[SR_BIN_BLOCK_SIZE];
+};
+
+struct FSR_TileBin
+{
+	FSR_BinBlock*	_head;
+	FSR_BinBlock*	_tail;
+};
+
+// per-frame triangle lists of the screen tiles.
+// triangles & lists live in arenas, which are reset when the bins are cleared.
+class FSR_TileBins
+{
+public:
+	FSR_TileBins();
+
+	// setup the tile grid over a w*h frame-buffer, must be empty.
+	void SetFrameSize(uint32_t w, uint32_t h);
+	// drop all triangles & states (keeps memory for the next frame)
+	void Clear();
+
+	bool IsEmpty() const { return _triangle_count == 0; }
+	void InvalidateDrawState() { _current_state = nullptr; }
+
+	// state of the following triangles, create a new one if invalidated.
+	const FSR_DrawState* AcquireDrawState(const FSR_Context& InContext);
+	// append a triangle to the bins of overlapped tiles
+	void AddTriangle(const FTiledRenderingContext& InTriangle);
+
+	// staging lists of the parallel geometry front-end, one per chunk of a draw.
+	// a chunk is filled by one job at a time, from its own arena.
+	void SetChunkCount(uint32_t InCount);
+	void StageChunkTriangle(uint32_t InChunk, const FTiledRenderingContext& InTriangle)
+	{
+		FSR_BinChunk& chunk = *_chunks[InChunk];
+		chunk._triangles.push_back(CopyTriangle(chunk._arena, InTriangle));
+	}
+	// bin the triangles of a chunk (in order) and empty its list
+	void AddChunkTriangles(uint32_t InChunk);
+
+	// bytes of the frame & chunk arenas in use
+	size_t ArenaBytesUsed() const;
+
+	uint32_t TileCount() const { return _tiles_x * _tiles_y; }
+	uint32_t TilesX() const { return _tiles_x; }
+	uint32_t TilesY() const { return _tiles_y; }
+
+	void GetTileRect(uint32_t InTileIndex, int32_t& OutX0, int32_t& OutY0, int32_t& OutX1, int32_t& OutY1) const
+	{
+		const int32_t tx = InTileIndex % _tiles_x;
+		const int32_t ty = InTileIndex / _tiles_x;
+		OutX0 = tx * SR_TILE_SIZE;
+		OutY0 = ty * SR_TILE_SIZE;
+		OutX1 = std::min<int32_t>(OutX0 + SR_TILE_SIZE, _w);
+		OutY1 = std::min<int32_t>(OutY0 + SR_TILE_SIZE, _h);
+	}
+
+	const FSR_TileBin& GetTileBin(uint32_t InTileIndex) const { return _bins[InTileIndex]; }
+
+protected:
+	static const FTiledRenderingContext* CopyTriangle(FSR_LinearArena& InArena, const FTiledRenderingContext& InTriangle)
+	{
+		void* tri = InArena.Allocate(InTriangle.Size(), alignof(FTiledRenderingContext));
+		memcpy(tri, &InTriangle, InTriangle.Size());
+		return static_cast<const FTiledRenderingContext*>(tri);
+	}
+
+	// bin a triangle which stays valid until Clear()
+	void BinTriangle(const FTiledRenderingContext* InTriangle);
+
+	struct FSR_BinChunk
+	{
+		FSR_LinearArena	_arena;
+		std::vector<const FTiledRenderingContext*>	_triangles; // keeps memory between draws
+	};
+
+	uint32_t _w, _h;
+	uint32_t _tiles_x, _tiles_y;
+
+	std::deque<FSR_DrawState>	_draw_states; // deque keeps the addresses stable
+	const FSR_DrawState*		_current_state;
+	bool						_bFarDepthWrites; // a state of the flush may write depth farther than the HiZ holds
+
+	FSR_LinearArena				_arena; // frame arena: triangles of AddTriangle() & bin blocks
+	uint32_t					_triangle_count;
+	std::vector<FSR_TileBin>	_bins;
+
+	std::vector<std::unique_ptr<FSR_BinChunk>>	_chunks;
+};
@@ -0,0 +1,79 @@
+// \brief
+//	adaptive partition of the tile grid into raster jobs.
+//	the cycles spent in each tile are measured, the next frame splits the hot tiles into
+//	smaller rectangles and merges the cold ones into larger squares.
+//
+
+#pragma once
+
+#include <vector>
+#include "SR_Common.h"
+
+
+class FSR_TileBins;
+
+// default job sizes in pixels, see FSR_Context::SetTileSizeRange()
+#define SR_TILE_JOB_MIN_SIZE		16
+#define SR_TILE_JOB_MAX_SIZE		256
+// jobs per thread aimed at, leaves room for the work stealing to even out the estimate errors
+#define SR_TILE_JOBS_PER_THREAD		4
+
+// a rectangle of the frame, inside a tile (split) or made of whole tiles (merged)
+struct FSR_TileJob
+{
+	int32_t		_x0, _y0, _x1, _y1;
+	uint32_t	_tile;		// tile of a split job
+	bool		_bSplit;	// shares its tile with other jobs
+	uint64_t	_estimate;	// cycles, from the last frame
+	uint64_t	_cycles;	// measured cycles of a split job
+};
+
+// not thread-safe, except RecordCycles() of distinct jobs.
+class FSR_TileScheduler
+{
+public:
+	FSR_TileScheduler();
+
+	// job sizes are clamped to [SR_HIZ_BLOCK_SIZE, SR_TILE_SIZE] and [SR_TILE_SIZE, ...], rounded to powers of two.
+	void SetSizeRange(uint32_t InMinSize, uint32_t InMaxSize);
+	uint32_t MinSize() const { return _min_size; }
+	uint32_t MaxSize() const { return _max_size; }
+
+	// the costs of the ending frame become the estimates of the next one
+	void BeginFrame();
+
+	// partition the tiles of InBins for InNumThreads threads, the heaviest jobs first.
+	// without estimates (first frame, resized grid) or a second thread, each tile is a job.
+	void Plan(const FSR_TileBins& InBins, uint32_t InNumThreads);
+
+	uint32_t JobCount() const { return static_cast<uint32_t>(_jobs.size()); }
+	const FSR_TileJob& GetJob(uint32_t InJobIndex) const { return _jobs[InJobIndex]; }
+
+	// cycles spent by job InJobIndex in tile InTileIndex
+	void RecordCycles(uint32_t InJobIndex, uint32_t InTileIndex, uint64_t InCycles)
+	{
+		FSR_TileJob& job = _jobs[InJobIndex];
+		if (job._bSplit) {
+			job._cycles += InCycles;
+		}
+		else {
+			// a merged job owns its tiles
+			_frame_cycles[InTileIndex] += InCycles;
+		}
+	}
+	// gather the cycles of the split jobs, once all jobs are done
+	void EndFlush();
+
+protected:
+	uint64_t RegionCost(uint32_t tx, uint32_t ty, uint32_t n) const;
+	void PlanRegion(const FSR_TileBins& InBins, uint32_t tx, uint32_t ty, uint32_t n, uint64_t InTarget);
+	void PlanTile(const FSR_TileBins& InBins, uint32_t tx, uint32_t ty, uint64_t InTarget);
+
+protected:
+	uint32_t _min_size, _max_size;
+	uint32_t _tiles_x, _tiles_y;
+
+	std::vector<uint64_t>		_last_cycles;	// per tile, of the last frame
+	std::vector<uint64_t>		_frame_cycles;	// per tile, of the current frame
+	std::vector<FSR_TileJob>	_jobs;
+};
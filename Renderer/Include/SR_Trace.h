@@ -0,0 +1,115 @@
+// \brief
+//	scoped trace events, exported as chrome trace_event json (chrome://tracing, ui.perfetto.dev).
+//	every thread records into its own buffer without locks, compiled out unless SR_ENABLE_TRACE.
+//
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include "SR_Common.h"
+#include "SR_Performance.h"
+
+
+// events per thread of a capture, later events are dropped
+#define SR_TRACE_EVENTS_PER_THREAD	(1 << 16)
+
+struct FSR_TraceEvent
+{
+	const char*	_name; // static string
+	double		_begin_microseconds;
+	double		_duration_microseconds;
+	int64_t		_arg;  // SR_INVALID_INDEX: none
+};
+
+// one producer, the owning thread
+class FSR_TraceBuffer
+{
+public:
+	FSR_TraceBuffer(uint32_t InThreadId, const char* InThreadName);
+
+	void Push(const FSR_TraceEvent& InEvent)
+	{
+		const uint32_t count = _count.load(std::memory_order_relaxed);
+		if (count >= SR_TRACE_EVENTS_PER_THREAD)
+		{
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		_events[count] = InEvent;
+		_count.store(count + 1, std::memory_order_release);
+	}
+
+public:
+	uint32_t		_thread_id;
+	std::string		_thread_name;
+	std::unique_ptr<FSR_TraceEvent[]>	_events;
+	std::atomic<uint32_t>	_count;
+	std::atomic<uint32_t>	_dropped;
+};
+
+class FSR_Trace
+{
+public:
+	static FSR_Trace& sharedInstance();
+
+	// a capture collects the events between Start() & Stop(), call them between frames.
+	void Start();
+	void Stop();
+	bool IsCapturing() const { return _bCapturing.load(std::memory_order_relaxed); }
+
+	// name of the calling thread in the trace, before its first event
+	void SetThreadName(const char* InName);
+
+	// buffer of the calling thread, registered on first use
+	FSR_TraceBuffer& ThreadBuffer();
+
+	// chrome trace_event json of the last capture
+	bool WriteChromeTrace(const char* InFilename) const;
+
+protected:
+	FSR_Trace() : _bCapturing(false) {}
+
+	std::atomic<bool>	_bCapturing;
+	mutable std::mutex	_mutex; // guards _buffers
+	std::vector<std::unique_ptr<FSR_TraceBuffer>>	_buffers;
+};
+
+// records one complete event over its lifetime
+class FSR_TraceScope
+{
+public:
+	explicit FSR_TraceScope(const char* InName, int64_t InArg = SR_INVALID_INDEX)
+		: _name(InName)
+		, _arg(InArg)
+		, _begin(FSR_Trace::sharedInstance().IsCapturing() ? appMicroSeconds() : -1.0)
+	{}
+
+	~FSR_TraceScope()
+	{
+		if (_begin >= 0.0)
+		{
+			FSR_Trace::sharedInstance().ThreadBuffer().Push({ _name, _begin, appMicroSeconds() - _begin, _arg });
+		}
+	}
+
+private:
+	const char*	_name;
+	int64_t		_arg;
+	double		_begin;
+};
+
+#if SR_ENABLE_TRACE
+#define SR_TRACE_CONCAT_INNER(a, b)		a##b
+#define SR_TRACE_CONCAT(a, b)			SR_TRACE_CONCAT_INNER(a, b)
+#define SR_TRACE_SCOPE(Name)				FSR_TraceScope SR_TRACE_CONCAT(_trace_scope_, __LINE__)(Name)
+#define SR_TRACE_SCOPE_ARG(Name, Arg)		FSR_TraceScope SR_TRACE_CONCAT(_trace_scope_, __LINE__)(Name, static_cast<int64_t>(Arg))
+#define SR_TRACE_THREAD_NAME(Name)		FSR_Trace::sharedInstance().SetThreadName(Name)
+#else
+#define SR_TRACE_SCOPE(Name)
+#define SR_TRACE_SCOPE_ARG(Name, Arg)
+#define SR_TRACE_THREAD_NAME(Name)
+#endif
@@ -0,0 +1,70 @@
+// \brief
+//	linear (bump) arena.
+//
+
+#include "SR_Arena.h"
+
+
+FSR_LinearArena::FSR_LinearArena(size_t InBlockSize)
+	: _current(0)
+	, _offset(0)
+	, _block_size(InBlockSize)
+	, _used_bytes(0)
+	, _peak_bytes(0)
+{
+}
+
+void* FSR_LinearArena::Allocate(size_t InSize, size_t InAlign)
+{
+	assert(InAlign && !(InAlign & (InAlign - 1)));
+
+	while (_current < _blocks.size())
+	{
+		FBlock& block = _blocks[_current];
+		const uintptr_t base = reinterpret_cast<uintptr_t>(block._data.get());
+		const size_t start = ((base + _offset + InAlign - 1) & ~uintptr_t(InAlign - 1)) - base;
+		if (start + InSize <= block._size)
+		{
+			_used_bytes += start + InSize - _offset;
+			_peak_bytes = std::max(_peak_bytes, _used_bytes);
+			_offset = start + InSize;
+			return block._data.get() + start;
+		}
+
+		// the rest of the block is wasted
+		++_current;
+		_offset = 0;
+	}
+
+	// a new block, large enough for the request
+	const size_t last = _blocks.empty() ? _block_size : _blocks.back()._size * 2;
+	FBlock block;
+	block._size = std::max(last, InSize + InAlign);
+	block._data.reset(new uint8_t[block._size]);
+	_blocks.push_back(std::move(block));
+	_current = static_cast<uint32_t>(_blocks.size() - 1);
+
+	return Allocate(InSize, InAlign);
+}
+
+void FSR_LinearArena::Reset()
+{
+	if (_blocks.size() > 1)
+	{
+		size_t total = 0;
+		for (const FBlock& block : _blocks)
+		{
+			total += block._size;
+		}
+
+		_blocks.clear();
+		FBlock block;
+		block._size = total;
+		block._data.reset(new uint8_t[total]);
+		_blocks.push_back(std::move(block));
+	}
+
+	_current = 0;
+	_offset = 0;
+	_used_bytes = 0;
+}
@@ -5,7 +5,8 @@
 #include "stb_image.h"
 #include "stb_image_write.h"
 #include "SR_Buffer2D.h"
-#include "SR_SSE.h"
+#include "SR_PixelAccess.h"
+#include "SR_JobSystem.h"
 
 #define SVPNG_LINKAGE	static
 #include "svpng.inc"
@@ -14,18 +15,61 @@
 const float FSR_Buffer2D::ONE_OVER_255 = (1.f / 255.f);
 const float FSR_Buffer2D::ONE_OVER_65535 = (1.f / 65535.f);
 
-FSR_Buffer2D::FSR_Buffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat)
+FSR_Buffer2D::FSR_Buffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat, bool InbTiled)
+	: FSR_Buffer2D(width, height, pixelformat, uint32_t(InbTiled ? SR_BUFFER_TILE_SHIFT : 0))
+{
+}
+
+FSR_Buffer2D::FSR_Buffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat, uint32_t InTileShift)
 	: _w(width)
 	, _h(height)
 	, _format(pixelformat)
+	, _tile_shift(InTileShift)
 {
+	_tile_mask = (1 << _tile_shift) - 1;
+	_pitch_w = (_w + _tile_mask) & ~_tile_mask;
+	_pitch_h = (_h + _tile_mask) & ~_tile_mask;
+
 	_bytes_per_pixel = LookupPixelFormatBytes(_format);
-	_bytes_per_line = _bytes_per_pixel * _w;
+	_bytes_per_line = _bytes_per_pixel * _pitch_w;
 
-	uint32_t bytes_cnt = _w * _h * _bytes_per_pixel;
+	uint32_t bytes_cnt = _pitch_w * _pitch_h * _bytes_per_pixel;
 	_buffer.resize(bytes_cnt);
 }
 
+void FSR_Buffer2D::Linearize(uint8_t* OutData, uint32_t InPitch) const
+{
+	const uint32_t bytes_per_row = _w * _bytes_per_pixel;
+	assert(bytes_per_row <= InPitch);
+
+	if (!IsTiled())
+	{
+		for (uint32_t cy = 0; cy < _h; ++cy, OutData += InPitch)
+		{
+			memcpy(OutData, GetRowData(cy), bytes_per_row);
+		}
+		return;
+	}
+
+	// a tile row is contiguous, copy the rows of its tiles
+	const uint32_t bytes_per_tile = _bytes_per_pixel << (_tile_shift << 1);
+	const uint32_t bytes_per_tile_row = _bytes_per_pixel << _tile_shift;
+	for (uint32_t cy = 0; cy < _h; ++cy, OutData += InPitch)
+	{
+		const uint8_t* src = GetRowData(cy);
+		uint8_t* dst = OutData;
+		uint32_t remain = bytes_per_row;
+		while (remain > 0)
+		{
+			const uint32_t bytes = std::min(remain, bytes_per_tile_row);
+			memcpy(dst, src, bytes);
+			src += bytes_per_tile;
+			dst += bytes;
+			remain -= bytes;
+		}
+	}
+}
+
 // sample element
 bool FSR_Buffer2D::Sample2DNearest(float u, float v, float RGBA[]) const
 {
@@ -84,6 +128,247 @@ bool FSR_Buffer2D::Sample2DLinear(float u, float v, float RGBA[]) const
 	return true;
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Mip chain
+
+// kaiser taps per axis of the 2x downsample, centered between source pixels 2x & 2x + 1
+#define SR_MIP_KAISER_TAPS		8
+#define SR_MIP_KAISER_ALPHA		4.f
+// rows per downsample job
+#define SR_MIP_ROWS_PER_JOB		16
+
+// zero-order modified bessel function of the first kind
+static float BesselI0(float x)
+{
+	float sum = 1.f, term = 1.f;
+	const float q = x * x * 0.25f;
+	for (int32_t k = 1; k < 16; ++k)
+	{
+		term *= q / float(k * k);
+		sum += term;
+	}
+	return sum;
+}
+
+static void ComputeKaiserWeights(float OutWeights[SR_MIP_KAISER_TAPS])
+{
+	// distance to the center in destination pixels, the window covers SR_MIP_KAISER_TAPS / 4 of them each side
+	const float radius = SR_MIP_KAISER_TAPS / 4.f;
+	float sum = 0.f;
+	for (int32_t k = 0; k < SR_MIP_KAISER_TAPS; ++k)
+	{
+		const float t = (k - SR_MIP_KAISER_TAPS / 2 + 0.5f) * 0.5f;
+		const float sinc = glm::sin(glm::pi<float>() * t) / (glm::pi<float>() * t);
+		const float r = t / radius;
+		const float window = BesselI0(SR_MIP_KAISER_ALPHA * sqrtf(std::max(0.f, 1.f - r * r))) / BesselI0(SR_MIP_KAISER_ALPHA);
+		OutWeights[k] = sinc * window;
+		sum += OutWeights[k];
+	}
+	for (int32_t k = 0; k < SR_MIP_KAISER_TAPS; ++k)
+	{
+		OutWeights[k] /= sum;
+	}
+}
+
+struct FMipDownsampleJob
+{
+	EMipFilter	_filter;
+	// rgba floats of the source level
+	const glm::vec4* _src;
+	uint32_t	_src_w, _src_h;
+	// kaiser: the source filtered along x, _dst_w x _src_h
+	glm::vec4*	_tmp;
+	// rgba floats & storage of the destination level
+	glm::vec4*	_dst;
+	FSR_Buffer2D* _dst_buffer;
+	uint32_t	_dst_w, _dst_h;
+	// unorm formats are clamped & rounded
+	bool		_bUNorm;
+	float		_weights[SR_MIP_KAISER_TAPS];
+};
+
+static void StoreMipRow(FMipDownsampleJob& Job, uint32_t dy)
+{
+	uint8_t* pRow = Job._dst_buffer->GetRowData(dy);
+	const glm::vec4* pColors = Job._dst + dy * Job._dst_w;
+	for (uint32_t dx = 0; dx < Job._dst_w; ++dx)
+	{
+		glm::vec4 color = pColors[dx];
+		if (Job._bUNorm)
+		{
+			color = glm::clamp(color, 0.f, 1.f) + glm::vec4(0.5f / 255.f);
+		}
+		Job._dst_buffer->Write(pRow, dx, &color.r);
+	}
+}
+
+static void DownsampleBoxRows(void* InData, uint32_t InIndex)
+{
+	FMipDownsampleJob& Job = *static_cast<FMipDownsampleJob*>(InData);
+	const uint32_t y0 = InIndex * SR_MIP_ROWS_PER_JOB;
+	const uint32_t y1 = std::min(y0 + SR_MIP_ROWS_PER_JOB, Job._dst_h);
+	for (uint32_t dy = y0; dy < y1; ++dy)
+	{
+		const glm::vec4* r0 = Job._src + (2 * dy) * Job._src_w;
+		const glm::vec4* r1 = Job._src + std::min(2 * dy + 1, Job._src_h - 1) * Job._src_w;
+		for (uint32_t dx = 0; dx < Job._dst_w; ++dx)
+		{
+			const uint32_t sx0 = 2 * dx;
+			const uint32_t sx1 = std::min(2 * dx + 1, Job._src_w - 1);
+			Job._dst[dy * Job._dst_w + dx] = (r0[sx0] + r0[sx1] + r1[sx0] + r1[sx1]) * 0.25f;
+		}
+		StoreMipRow(Job, dy);
+	}
+}
+
+// pass 1: filter the source rows along x
+static void DownsampleKaiserRowsX(void* InData, uint32_t InIndex)
+{
+	FMipDownsampleJob& Job = *static_cast<FMipDownsampleJob*>(InData);
+	const uint32_t y0 = InIndex * SR_MIP_ROWS_PER_JOB;
+	const uint32_t y1 = std::min(y0 + SR_MIP_ROWS_PER_JOB, Job._src_h);
+	for (uint32_t sy = y0; sy < y1; ++sy)
+	{
+		const glm::vec4* pSrc = Job._src + sy * Job._src_w;
+		for (uint32_t dx = 0; dx < Job._dst_w; ++dx)
+		{
+			glm::vec4 sum(0.f);
+			for (int32_t k = 0; k < SR_MIP_KAISER_TAPS; ++k)
+			{
+				// textures repeat
+				const int32_t sx = int32_t(2 * dx) + k - (SR_MIP_KAISER_TAPS / 2 - 1);
+				sum += pSrc[(sx % int32_t(Job._src_w) + Job._src_w) % Job._src_w] * Job._weights[k];
+			}
+			Job._tmp[sy * Job._dst_w + dx] = sum;
+		}
+	}
+}
+
+// pass 2: filter the columns of pass 1 along y
+static void DownsampleKaiserRowsY(void* InData, uint32_t InIndex)
+{
+	FMipDownsampleJob& Job = *static_cast<FMipDownsampleJob*>(InData);
+	const uint32_t y0 = InIndex * SR_MIP_ROWS_PER_JOB;
+	const uint32_t y1 = std::min(y0 + SR_MIP_ROWS_PER_JOB, Job._dst_h);
+	for (uint32_t dy = y0; dy < y1; ++dy)
+	{
+		glm::vec4* pDst = Job._dst + dy * Job._dst_w;
+		std::fill(pDst, pDst + Job._dst_w, glm::vec4(0.f));
+		for (int32_t k = 0; k < SR_MIP_KAISER_TAPS; ++k)
+		{
+			const int32_t sy = int32_t(2 * dy) + k - (SR_MIP_KAISER_TAPS / 2 - 1);
+			const glm::vec4* pTmp = Job._tmp + ((sy % int32_t(Job._src_h) + Job._src_h) % Job._src_h) * Job._dst_w;
+			for (uint32_t dx = 0; dx < Job._dst_w; ++dx)
+			{
+				pDst[dx] += pTmp[dx] * Job._weights[k];
+			}
+		}
+		StoreMipRow(Job, dy);
+	}
+}
+
+void FSR_Buffer2D::GenerateMips(EMipFilter InFilter)
+{
+	_mips.clear();
+
+	FMipDownsampleJob Job;
+	Job._filter = InFilter;
+	Job._bUNorm = (_format == EPixelFormat::PIXEL_FORMAT_RGB888 || _format == EPixelFormat::PIXEL_FORMAT_RGBA8888);
+	ComputeKaiserWeights(Job._weights);
+
+	// level 0 as rgba floats
+	std::vector<glm::vec4> src(_w * _h), dst, tmp;
+	for (uint32_t cy = 0; cy < _h; ++cy)
+	{
+		const uint8_t* pRow = GetRowData(cy);
+		for (uint32_t cx = 0; cx < _w; ++cx)
+		{
+			Read(pRow, cx, &src[cy * _w + cx].r);
+		}
+	}
+
+	uint32_t w = _w, h = _h;
+	while (w > 1 || h > 1)
+	{
+		const uint32_t dw = std::max(w >> 1, 1u);
+		const uint32_t dh = std::max(h >> 1, 1u);
+		std::shared_ptr<FSR_Buffer2D> mip = CreateMipLevel(dw, dh);
+		assert(mip);
+
+		dst.resize(dw * dh);
+		Job._src = src.data();
+		Job._src_w = w;
+		Job._src_h = h;
+		Job._dst = dst.data();
+		Job._dst_buffer = mip.get();
+		Job._dst_w = dw;
+		Job._dst_h = dh;
+
+		FSR_JobSystem& JobSystem = FSR_JobSystem::sharedInstance();
+		if (InFilter == EMipFilter::MIP_FILTER_KAISER)
+		{
+			tmp.resize(dw * h);
+			Job._tmp = tmp.data();
+			JobSystem.ParallelFor(&DownsampleKaiserRowsX, &Job, (h + SR_MIP_ROWS_PER_JOB - 1) / SR_MIP_ROWS_PER_JOB);
+			JobSystem.ParallelFor(&DownsampleKaiserRowsY, &Job, (dh + SR_MIP_ROWS_PER_JOB - 1) / SR_MIP_ROWS_PER_JOB);
+		}
+		else
+		{
+			JobSystem.ParallelFor(&DownsampleBoxRows, &Job, (dh + SR_MIP_ROWS_PER_JOB - 1) / SR_MIP_ROWS_PER_JOB);
+		}
+
+		_mips.push_back(mip);
+		// the next level filters the unquantized colors
+		src.swap(dst);
+		w = dw;
+		h = dh;
+	}
+}
+
+std::shared_ptr<FSR_Buffer2D> FSR_Buffer2D::CreateMipLevel(uint32_t width, uint32_t height) const
+{
+	return FSR_Buffer2D_Helper::CreateBuffer2D(width, height, _format, IsTiled());
+}
+
+float FSR_Buffer2D::ComputeLod(float dudx, float dvdx, float dudy, float dvdy) const
+{
+	// footprint in texels of level 0
+	const float xx = dudx * _w, xy = dvdx * _h;
+	const float yx = dudy * _w, yy = dvdy * _h;
+	const float rho2 = std::max(xx * xx + xy * xy, yx * yx + yy * yy);
+
+	return rho2 > 0.f ? 0.5f * log2f(rho2) : 0.f;
+}
+
+bool FSR_Buffer2D::Sample2DNearestMip(float u, float v, float lod, float RGBA[]) const
+{
+	const int32_t level = static_cast<int32_t>(lod + 0.5f);
+	const uint32_t clamped = static_cast<uint32_t>(glm::clamp<int32_t>(level, 0, MipCount() - 1));
+
+	return GetMip(clamped)->Sample2DNearest(u, v, RGBA);
+}
+
+bool FSR_Buffer2D::Sample2DTrilinear(float u, float v, float lod, float RGBA[]) const
+{
+	lod = glm::clamp(lod, 0.f, float(MipCount() - 1));
+	const uint32_t level = static_cast<uint32_t>(lod);
+	const float t = lod - level;
+
+	if (t <= 0.f)
+	{
+		return GetMip(level)->Sample2DLinear(u, v, RGBA);
+	}
+
+	glm::vec4 c0, c1;
+	GetMip(level)->Sample2DLinear(u, v, &c0.r);
+	GetMip(level + 1)->Sample2DLinear(u, v, &c1.r);
+
+	const glm::vec4 result = glm::mix(c0, c1, t);
+	memcpy(RGBA, &result.r, sizeof(float) * 4);
+
+	return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // PIXEL_FORMAT_U16
 
@@ -92,7 +377,7 @@ bool FSR_Buffer2D_U16::Read(const uint8_t *pRow, uint32_t cx, uint8_t RGBA[]) co
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 2);
 
-	const uint8_t* pData = pRow + (cx << 1);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 1);
 	RGBA[0] = (uint8_t)(*(reinterpret_cast<const uint16_t*>(pData)));
 	RGBA[1] = RGBA[2] = 0;
 	RGBA[3] = 255;
@@ -104,7 +389,7 @@ bool FSR_Buffer2D_U16::Read(const uint8_t *pRow, uint32_t cx, uint16_t& Value) c
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 2);
 
-	const uint8_t* pData = pRow + (cx << 1);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 1);
 	Value = (uint8_t)(*(reinterpret_cast<const uint16_t*>(pData)));
 
 	return true;
@@ -116,7 +401,7 @@ bool FSR_Buffer2D_U16::Read(const uint8_t *pRow, uint32_t cx, float RGBA[]) cons
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 2);
 
-	const uint8_t* pData = pRow + (cx << 1);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 1);
 	RGBA[0] = *(reinterpret_cast<const uint16_t*>(pData)) * ONE_OVER_65535;
 	RGBA[1] = RGBA[2] = 0.f;
 	RGBA[3] = 1.f;
@@ -129,7 +414,7 @@ bool FSR_Buffer2D_U16::Read(const uint8_t *pRow, uint32_t cx, float& Value) cons
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 2);
 
-	const uint8_t* pData = pRow + (cx << 1);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 1);
 	Value = *(reinterpret_cast<const uint16_t*>(pData)) * ONE_OVER_65535;
 	return true;
 }
@@ -139,7 +424,7 @@ bool FSR_Buffer2D_U16::Write(uint8_t *pRow, uint32_t cx, const uint8_t RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 2);
 
-	uint8_t* pData = pRow + (cx << 1);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 1);
 	*(reinterpret_cast<uint16_t*>(pData)) = RGBA[0];
 	return true;
 }
@@ -149,7 +434,7 @@ bool FSR_Buffer2D_U16::Write(uint8_t *pRow, uint32_t cx, uint16_t& Value)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 2);
 
-	uint8_t* pData = pRow + (cx << 1);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 1);
 	*(reinterpret_cast<uint16_t*>(pData)) = Value;
 	return true;
 }
@@ -159,7 +444,7 @@ bool FSR_Buffer2D_U16::Write(uint8_t *pRow, uint32_t cx, const float RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 2);
 
-	uint8_t* pData = pRow + (cx << 1);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 1);
 	*(reinterpret_cast<uint16_t*>(pData)) = glm::clamp<uint16_t>(uint16_t(RGBA[0] * 65535.f), 0, 65535);
 	return true;
 }
@@ -169,7 +454,7 @@ bool FSR_Buffer2D_U16::Write(uint8_t *pRow, uint32_t cx, float R)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 2);
 
-	uint8_t* pData = pRow + (cx << 1);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 1);
 	*(reinterpret_cast<uint16_t*>(pData)) = glm::clamp<uint16_t>(uint16_t(R * 65535.f), 0, 65535);
 	return true;
 }
@@ -180,7 +465,7 @@ void FSR_Buffer2D_U16::Clear(const float RGBA[])
 	uint16_t* pData = reinterpret_cast<uint16_t*>(_buffer.data());
 	
 	// fill first line
-	for (uint32_t k = 0; k < _w; ++k)
+	for (uint32_t k = 0; k < _pitch_w; ++k)
 	{
 		*pData++ = R16;
 	}
@@ -188,7 +473,7 @@ void FSR_Buffer2D_U16::Clear(const float RGBA[])
 	uint32_t bytes_per_line = BytesPerLine();
 	uint8_t* src = reinterpret_cast<uint8_t*>(_buffer.data());
 	uint8_t* dst = src + bytes_per_line;
-	for (uint32_t k = 1; k < _h; ++k)
+	for (uint32_t k = 1; k < _pitch_h; ++k)
 	{
 		memcpy(dst, src, bytes_per_line);
 		src = dst;
@@ -204,7 +489,7 @@ bool FSR_Buffer2D_F32::Read(const uint8_t *pRow, uint32_t cx, uint8_t RGBA[]) co
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	const uint8_t* pData = pRow + (cx << 2);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	float Val = *(reinterpret_cast<const float*>(pData));
 	RGBA[0] = glm::clamp<uint8_t>(uint8_t(Val * 255), 0, 255);
 	RGBA[1] = RGBA[2] = 0;
@@ -216,7 +501,7 @@ bool FSR_Buffer2D_F32::Read(const uint8_t *pRow, uint32_t cx, uint16_t& Value) c
 {
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
-	const uint8_t* pData = pRow + (cx << 2);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 
 	return false;
 }
@@ -227,7 +512,7 @@ bool FSR_Buffer2D_F32::Read(const uint8_t *pRow, uint32_t cx, float RGBA[]) cons
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	const uint8_t* pData = pRow + (cx << 2);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	RGBA[0] = *(reinterpret_cast<const float*>(pData));
 	RGBA[1] = RGBA[2] = 0.f;
 	RGBA[3] = 1.f;
@@ -239,8 +524,7 @@ bool FSR_Buffer2D_F32::Read(const uint8_t *pRow, uint32_t cx, float& Value) cons
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	const uint8_t* pData = pRow + (cx << 2);
-	Value = *(reinterpret_cast<const float*>(pData));
+	Value = TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_F32>::ReadDepth(this, pRow, cx);
 	return true;
 }
 
@@ -249,7 +533,7 @@ bool FSR_Buffer2D_F32::Write(uint8_t *pRow, uint32_t cx, const uint8_t RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	uint8_t* pData = pRow + (cx << 2);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	*(reinterpret_cast<float*>(pData)) = RGBA[0] * ONE_OVER_255;
 	return true;
 }
@@ -259,7 +543,7 @@ bool FSR_Buffer2D_F32::Write(uint8_t *pRow, uint32_t cx, uint16_t& Value)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	uint8_t* pData = pRow + (cx << 2);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	*(reinterpret_cast<float*>(pData)) = Value * ONE_OVER_65535;
 	return true;
 }
@@ -269,7 +553,7 @@ bool FSR_Buffer2D_F32::Write(uint8_t *pRow, uint32_t cx, const float RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	uint8_t* pData = pRow + (cx << 2);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	*(reinterpret_cast<float*>(pData)) = RGBA[0];
 
 	return true;
@@ -280,9 +564,7 @@ bool FSR_Buffer2D_F32::Write(uint8_t *pRow, uint32_t cx, float R)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	uint8_t* pData = pRow + (cx << 2);
-	*(reinterpret_cast<float*>(pData)) = R;
-
+	TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_F32>::WriteDepth(this, pRow, cx, R);
 	return true;
 }
 
@@ -291,7 +573,7 @@ void FSR_Buffer2D_F32::Clear(const float RGBA[])
 	float* pData = reinterpret_cast<float*>(_buffer.data());
 
 	// fill first line
-	for (uint32_t k = 0; k < _w; ++k)
+	for (uint32_t k = 0; k < _pitch_w; ++k)
 	{
 		*pData++ = RGBA[0];
 	}
@@ -299,7 +581,7 @@ void FSR_Buffer2D_F32::Clear(const float RGBA[])
 	uint32_t bytes_per_line = BytesPerLine();
 	uint8_t* src = reinterpret_cast<uint8_t*>(_buffer.data());
 	uint8_t* dst = src + bytes_per_line;
-	for (uint32_t k = 1; k < _h; ++k)
+	for (uint32_t k = 1; k < _pitch_h; ++k)
 	{
 		memcpy(dst, src, bytes_per_line);
 		src = dst;
@@ -315,7 +597,7 @@ bool FSR_Buffer2D_RGB888::Read(const uint8_t *pRow, uint32_t cx, uint8_t RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 3);
 
-	const uint8_t* pData = pRow + ((cx << 1) + cx);
+	const uint8_t* pData = pRow + ColumnIndex(cx) * 3;
 	RGBA[0] = pData[0];  
 	RGBA[1] = pData[1]; 
 	RGBA[2] = pData[2]; 
@@ -330,7 +612,7 @@ bool FSR_Buffer2D_RGB888::Read(const uint8_t *pRow, uint32_t cx, uint16_t& Value
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 3);
 
-	const uint8_t* pData = pRow + ((cx << 1) + cx);
+	const uint8_t* pData = pRow + ColumnIndex(cx) * 3;
 	return false;
 }
 
@@ -340,7 +622,7 @@ bool FSR_Buffer2D_RGB888::Read(const uint8_t *pRow, uint32_t cx, float RGBA[]) c
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 3);
 
-	const uint8_t* pData = pRow + ((cx << 1) + cx);
+	const uint8_t* pData = pRow + ColumnIndex(cx) * 3;
 	uint8_t rgba[4] = { pData[0], pData[1], pData[2], 255 };
 
 	VectorRegister clr0 = VectorLoadByte4(rgba);
@@ -354,7 +636,7 @@ bool FSR_Buffer2D_RGB888::Read(const uint8_t *pRow, uint32_t cx, float& Value) c
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 3);
 
-	const uint8_t* pData = pRow + ((cx << 1) + cx);
+	const uint8_t* pData = pRow + ColumnIndex(cx) * 3;
 	Value = (*pData) * ONE_OVER_255;
 
 	return true;
@@ -365,7 +647,7 @@ bool FSR_Buffer2D_RGB888::Write(uint8_t *pRow, uint32_t cx, const uint8_t RGBA[]
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 3);
 
-	uint8_t* pData = pRow + ((cx << 1) + cx);
+	uint8_t* pData = pRow + ColumnIndex(cx) * 3;
 	pData[0] = RGBA[0];  
 	pData[1] = RGBA[1]; 
 	pData[2] = RGBA[2];
@@ -378,7 +660,7 @@ bool FSR_Buffer2D_RGB888::Write(uint8_t *pRow, uint32_t cx, uint16_t& Value)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 3);
 
-	uint8_t* pData = pRow + ((cx << 1) + cx);
+	uint8_t* pData = pRow + ColumnIndex(cx) * 3;
 	return false;
 }
 
@@ -387,7 +669,7 @@ bool FSR_Buffer2D_RGB888::Write(uint8_t *pRow, uint32_t cx, const float RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 3);
 
-	uint8_t* pData = pRow + ((cx << 1) + cx);
+	uint8_t* pData = pRow + ColumnIndex(cx) * 3;
 	pData[0] = glm::clamp<uint8_t>(uint8_t(RGBA[0] * 255), 0, 255);
 	pData[1] = glm::clamp<uint8_t>(uint8_t(RGBA[1] * 255), 0, 255);
 	pData[2] = glm::clamp<uint8_t>(uint8_t(RGBA[2] * 255), 0, 255);
@@ -400,7 +682,7 @@ bool FSR_Buffer2D_RGB888::Write(uint8_t *pRow, uint32_t cx, float R)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 3);
 
-	uint8_t* pData = pRow + ((cx << 1) + cx);
+	uint8_t* pData = pRow + ColumnIndex(cx) * 3;
 	*pData = glm::clamp<uint8_t>(uint8_t(R * 255), 0, 255);
 
 	return true;
@@ -414,7 +696,7 @@ void FSR_Buffer2D_RGB888::Clear(const float RGBA[])
 	uint8_t* pData = reinterpret_cast<uint8_t*>(_buffer.data());
 
 	// fill first line
-	for (uint32_t k = 0; k < _w; ++k)
+	for (uint32_t k = 0; k < _pitch_w; ++k)
 	{
 		*pData++ = R8;
 		*pData++ = G8;
@@ -424,7 +706,7 @@ void FSR_Buffer2D_RGB888::Clear(const float RGBA[])
 	uint32_t bytes_per_line = BytesPerLine();
 	uint8_t* src = reinterpret_cast<uint8_t*>(_buffer.data());
 	uint8_t* dst = src + bytes_per_line;
-	for (uint32_t k = 1; k < _h; ++k)
+	for (uint32_t k = 1; k < _pitch_h; ++k)
 	{
 		memcpy(dst, src, bytes_per_line);
 		src = dst;
@@ -440,7 +722,7 @@ bool FSR_Buffer2D_RGBA8888::Read(const uint8_t *pRow, uint32_t cx, uint8_t RGBA[
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	const uint8_t* pData = pRow + (cx << 2);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	RGBA[0] = pData[0];
 	RGBA[1] = pData[1];
 	RGBA[2] = pData[2];
@@ -454,7 +736,7 @@ bool FSR_Buffer2D_RGBA8888::Read(const uint8_t *pRow, uint32_t cx, uint16_t& Val
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	const uint8_t* pData = pRow + (cx << 2);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	return false;
 }
 
@@ -464,12 +746,7 @@ bool FSR_Buffer2D_RGBA8888::Read(const uint8_t *pRow, uint32_t cx, float RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	const uint8_t* pData = pRow + (cx << 2);
-	
-	VectorRegister clr0 = VectorLoadByte4(pData);
-	VectorRegister clr1 = VectorMultiply(clr0, VectorRegsiterConstants::FloatOneOver255);
-	VectorStore(clr1, RGBA);
-
+	TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_RGBA8888>::ReadColor(this, pRow, cx, RGBA);
 	return true;
 }
 
@@ -478,7 +755,7 @@ bool FSR_Buffer2D_RGBA8888::Read(const uint8_t *pRow, uint32_t cx, float& Value)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	const uint8_t* pData = pRow + (cx << 2);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	Value = (*pData) * ONE_OVER_255;
 
 	return true;
@@ -489,7 +766,7 @@ bool FSR_Buffer2D_RGBA8888::Write(uint8_t *pRow, uint32_t cx, const uint8_t RGBA
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	uint8_t* pData = pRow + (cx << 2);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	pData[0] = RGBA[0];
 	pData[1] = RGBA[1];
 	pData[2] = RGBA[2];
@@ -503,7 +780,7 @@ bool FSR_Buffer2D_RGBA8888::Write(uint8_t *pRow, uint32_t cx, uint16_t& Value)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	uint8_t* pData = pRow + (cx << 2);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	return false;
 }
 
@@ -512,12 +789,7 @@ bool FSR_Buffer2D_RGBA8888::Write(uint8_t *pRow, uint32_t cx, const float RGBA[]
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	uint8_t* pData = pRow + (cx << 2);
-
-	VectorRegister clr0 = VectorLoad(RGBA);
-	VectorRegister clr1 = VectorMultiply(clr0, VectorRegsiterConstants::Float255);
-	VectorStoreByte4(clr1, pData);
-
+	TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_RGBA8888>::WriteColor(this, pRow, cx, RGBA);
 	return true;
 }
 
@@ -526,7 +798,7 @@ bool FSR_Buffer2D_RGBA8888::Write(uint8_t *pRow, uint32_t cx, float R)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 4);
 
-	uint8_t* pData = pRow + (cx << 2);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 2);
 	*pData = glm::clamp<uint8_t>(uint8_t(R * 255), 0, 255);
 
 	return true;
@@ -541,7 +813,7 @@ void FSR_Buffer2D_RGBA8888::Clear(const float RGBA[])
 	uint8_t* pData = reinterpret_cast<uint8_t*>(_buffer.data());
 
 	// fill first line
-	for (uint32_t k = 0; k < _w; ++k)
+	for (uint32_t k = 0; k < _pitch_w; ++k)
 	{
 		*pData++ = R8;
 		*pData++ = G8;
@@ -552,7 +824,7 @@ void FSR_Buffer2D_RGBA8888::Clear(const float RGBA[])
 	uint32_t bytes_per_line = BytesPerLine();
 	uint8_t* src = reinterpret_cast<uint8_t*>(_buffer.data());
 	uint8_t* dst = src + bytes_per_line;
-	for (uint32_t k = 1; k < _h; ++k)
+	for (uint32_t k = 1; k < _pitch_h; ++k)
 	{
 		memcpy(dst, src, bytes_per_line);
 		src = dst;
@@ -568,7 +840,7 @@ bool FSR_Buffer2D_RGBF32::Read(const uint8_t *pRow, uint32_t cx, uint8_t RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 12);
 
-	const uint8_t* pData = pRow + ((cx << 3) + (cx << 2));
+	const uint8_t* pData = pRow + ColumnIndex(cx) * 12;
 	const float* pFloat = reinterpret_cast<const float*>(pData);
 	RGBA[0] = glm::clamp<uint8_t>(uint8_t(pFloat[0] * 255), 0, 255);
 	RGBA[1] = glm::clamp<uint8_t>(uint8_t(pFloat[1] * 255), 0, 255);
@@ -583,7 +855,7 @@ bool FSR_Buffer2D_RGBF32::Read(const uint8_t *pRow, uint32_t cx, uint16_t& Value
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 12);
 
-	const uint8_t* pData = pRow + ((cx << 3) + (cx << 2));
+	const uint8_t* pData = pRow + ColumnIndex(cx) * 12;
 	return false;
 }
 
@@ -593,7 +865,7 @@ bool FSR_Buffer2D_RGBF32::Read(const uint8_t *pRow, uint32_t cx, float RGBA[]) c
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 12);
 
-	const uint8_t* pData = pRow + ((cx << 3) + (cx << 2));
+	const uint8_t* pData = pRow + ColumnIndex(cx) * 12;
 	const float* pFloat = reinterpret_cast<const float*>(pData);
 	RGBA[0] = pFloat[0];
 	RGBA[1] = pFloat[1];
@@ -608,7 +880,7 @@ bool FSR_Buffer2D_RGBF32::Read(const uint8_t *pRow, uint32_t cx, float& Value) c
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 12);
 
-	const uint8_t* pData = pRow + ((cx << 3) + (cx << 2));
+	const uint8_t* pData = pRow + ColumnIndex(cx) * 12;
 	const float* pFloat = reinterpret_cast<const float*>(pData);
 	Value = *pFloat;
 
@@ -620,7 +892,7 @@ bool FSR_Buffer2D_RGBF32::Write(uint8_t *pRow, uint32_t cx, const uint8_t RGBA[]
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 12);
 
-	uint8_t* pData = pRow + ((cx << 3) + (cx << 2));
+	uint8_t* pData = pRow + ColumnIndex(cx) * 12;
 	float* pFloat = reinterpret_cast<float*>(pData);
 	pFloat[0] = RGBA[0] * ONE_OVER_255;
 	pFloat[1] = RGBA[1] * ONE_OVER_255;
@@ -634,7 +906,7 @@ bool FSR_Buffer2D_RGBF32::Write(uint8_t *pRow, uint32_t cx, uint16_t& Value)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 12);
 
-	uint8_t* pData = pRow + ((cx << 3) + (cx << 2));
+	uint8_t* pData = pRow + ColumnIndex(cx) * 12;
 	*(reinterpret_cast<float*>(pData)) = Value * ONE_OVER_65535;
 
 	return true;
@@ -645,7 +917,7 @@ bool FSR_Buffer2D_RGBF32::Write(uint8_t *pRow, uint32_t cx, const float RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 12);
 
-	uint8_t* pData = pRow + ((cx << 3) + (cx << 2));
+	uint8_t* pData = pRow + ColumnIndex(cx) * 12;
 	memcpy(pData, RGBA, sizeof(float)*3);
 
 	return true;
@@ -656,7 +928,7 @@ bool FSR_Buffer2D_RGBF32::Write(uint8_t *pRow, uint32_t cx, float R)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 12);
 
-	uint8_t* pData = pRow + ((cx << 3) + (cx << 2));
+	uint8_t* pData = pRow + ColumnIndex(cx) * 12;
 	float* pFloat = reinterpret_cast<float*>(pData);
 	*pFloat = R;
 
@@ -668,7 +940,7 @@ void FSR_Buffer2D_RGBF32::Clear(const float RGBA[])
 	float* pData = reinterpret_cast<float*>(_buffer.data());
 
 	// fill first line
-	for (uint32_t k = 0; k < _w; ++k, pData+=3)
+	for (uint32_t k = 0; k < _pitch_w; ++k, pData+=3)
 	{
 		memcpy(pData, RGBA, sizeof(float) * 3);
 	}
@@ -676,7 +948,7 @@ void FSR_Buffer2D_RGBF32::Clear(const float RGBA[])
 	uint32_t bytes_per_line = BytesPerLine();
 	uint8_t* src = reinterpret_cast<uint8_t*>(_buffer.data());
 	uint8_t* dst = src + bytes_per_line;
-	for (uint32_t k = 1; k < _h; ++k)
+	for (uint32_t k = 1; k < _pitch_h; ++k)
 	{
 		memcpy(dst, src, bytes_per_line);
 		src = dst;
@@ -692,7 +964,7 @@ bool FSR_Buffer2D_RGBAF32::Read(const uint8_t *pRow, uint32_t cx, uint8_t RGBA[]
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 16);
 
-	const uint8_t* pData = pRow + (cx << 4);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 4);
 	const float* pFloat = reinterpret_cast<const float*>(pData);
 	RGBA[0] = glm::clamp<uint8_t>(uint8_t(pFloat[0] * 255), 0, 255);
 	RGBA[1] = glm::clamp<uint8_t>(uint8_t(pFloat[1] * 255), 0, 255);
@@ -707,7 +979,7 @@ bool FSR_Buffer2D_RGBAF32::Read(const uint8_t *pRow, uint32_t cx, uint16_t& Valu
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 16);
 
-	const uint8_t* pData = pRow + (cx << 4);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 4);
 	return false;
 }
 
@@ -717,13 +989,7 @@ bool FSR_Buffer2D_RGBAF32::Read(const uint8_t *pRow, uint32_t cx, float RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 16);
 
-	const uint8_t* pData = pRow + (cx << 4);
-	const float* pFloat = reinterpret_cast<const float*>(pData);
-	RGBA[0] = pFloat[0];
-	RGBA[1] = pFloat[1];
-	RGBA[2] = pFloat[2];
-	RGBA[3] = pFloat[3];
-
+	TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_RGBAF32>::ReadColor(this, pRow, cx, RGBA);
 	return true;
 }
 
@@ -732,7 +998,7 @@ bool FSR_Buffer2D_RGBAF32::Read(const uint8_t *pRow, uint32_t cx, float& Value)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 16);
 
-	const uint8_t* pData = pRow + (cx << 4);
+	const uint8_t* pData = pRow + (ColumnIndex(cx) << 4);
 	const float* pFloat = reinterpret_cast<const float*>(pData);
 	Value = *pFloat;
 
@@ -744,7 +1010,7 @@ bool FSR_Buffer2D_RGBAF32::Write(uint8_t *pRow, uint32_t cx, const uint8_t RGBA[
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 16);
 
-	uint8_t* pData = pRow + (cx << 4);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 4);
 	float* pFloat = reinterpret_cast<float*>(pData);
 	pFloat[0] = RGBA[0] * ONE_OVER_255;
 	pFloat[1] = RGBA[1] * ONE_OVER_255;
@@ -759,7 +1025,7 @@ bool FSR_Buffer2D_RGBAF32::Write(uint8_t *pRow, uint32_t cx, uint16_t& Value)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 16);
 
-	uint8_t* pData = pRow + (cx << 4);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 4);
 	*(reinterpret_cast<float*>(pData)) = Value * ONE_OVER_65535;
 
 	return true;
@@ -770,9 +1036,7 @@ bool FSR_Buffer2D_RGBAF32::Write(uint8_t *pRow, uint32_t cx, const float RGBA[])
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 16);
 
-	uint8_t* pData = pRow + (cx << 4);
-	memcpy(pData, RGBA, sizeof(float) * 4);
-
+	TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_RGBAF32>::WriteColor(this, pRow, cx, RGBA);
 	return true;
 }
 
@@ -781,7 +1045,7 @@ bool FSR_Buffer2D_RGBAF32::Write(uint8_t *pRow, uint32_t cx, float R)
 	assert(cx < _w);
 	assert(_bytes_per_pixel == 16);
 
-	uint8_t* pData = pRow + (cx << 4);
+	uint8_t* pData = pRow + (ColumnIndex(cx) << 4);
 	float* pFloat = reinterpret_cast<float*>(pData);
 	*pFloat = R;
 
@@ -793,7 +1057,7 @@ void FSR_Buffer2D_RGBAF32::Clear(const float RGBA[])
 	float* pData = reinterpret_cast<float*>(_buffer.data());
 
 	// fill first line
-	for (uint32_t k = 0; k < _w; ++k, pData+=4)
+	for (uint32_t k = 0; k < _pitch_w; ++k, pData+=4)
 	{
 		memcpy(pData, RGBA, sizeof(float) * 4);
 	}
@@ -801,7 +1065,7 @@ void FSR_Buffer2D_RGBAF32::Clear(const float RGBA[])
 	uint32_t bytes_per_line = BytesPerLine();
 	uint8_t* src = reinterpret_cast<uint8_t*>(_buffer.data());
 	uint8_t* dst = src + bytes_per_line;
-	for (uint32_t k = 1; k < _h; ++k)
+	for (uint32_t k = 1; k < _pitch_h; ++k)
 	{
 		memcpy(dst, src, bytes_per_line);
 		src = dst;
@@ -809,32 +1073,106 @@ void FSR_Buffer2D_RGBAF32::Clear(const float RGBA[])
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////
+// Swizzled Texture
+
+// same texels & weights as FSR_Buffer2D::Sample2DNearest/Sample2DLinear, only the fetch differs
+bool FSR_Texture2D_Swizzled::Sample2DNearest(float u, float v, float RGBA[]) const
+{
+	u = u - floorf(u);
+	v = v - floorf(v);
+
+	const uint32_t cx = uint32_t((_w - 1) * u);
+	const uint32_t cy = uint32_t((_h - 1) * v);
+
+	assert(cx < _w && cy < _h);
+	TSR_PixelAccess<EPixelFormat::PIXEL_FORMAT_RGBA8888>::ReadColor(this, GetRowData(cy), cx, RGBA);
+	return true;
+}
+
+bool FSR_Texture2D_Swizzled::Sample2DLinear(float u, float v, float RGBA[]) const
+{
+	u = u - floorf(u);
+	v = v - floorf(v);
+
+	float cx0 = _w * u;
+	if (cx0 >= _w) { cx0 -= _w; }
+
+	float cx1 = cx0 + 1.f;
+	if (cx1 >= _w) { cx1 -= _w; }
+
+	float cy0 = _h * v;
+	if (cy0 >= _h) { cy0 -= _h; }
+
+	float cy1 = cy0 + 1.f;
+	if (cy1 >= _h) { cy1 -= _h; }
+
+	const float tu = 1.f - (cx0 - floorf(cx0));
+	const float tv = 1.f - (cy0 - floorf(cy0));
+
+	/*  c2|c3
+	  ----+-----
+		c0|c1
+	*/
+	const uint32_t col0 = ColumnIndex(static_cast<uint32_t>(cx0)) << 2;
+	const uint32_t col1 = ColumnIndex(static_cast<uint32_t>(cx1)) << 2;
+	const uint8_t* pRow0 = GetRowData(static_cast<uint32_t>(cy0));
+	const uint8_t* pRow1 = GetRowData(static_cast<uint32_t>(cy1));
+
+	// 4 taps in a register, unpacked to 4 x 4 floats
+	const __m128i Taps = _mm_setr_epi32(*reinterpret_cast<const int32_t*>(pRow0 + col0), *reinterpret_cast<const int32_t*>(pRow0 + col1),
+		*reinterpret_cast<const int32_t*>(pRow1 + col0), *reinterpret_cast<const int32_t*>(pRow1 + col1));
+	const __m128i Zero = _mm_setzero_si128();
+	const __m128i Taps01 = _mm_unpacklo_epi8(Taps, Zero);
+	const __m128i Taps23 = _mm_unpackhi_epi8(Taps, Zero);
+	const VectorRegister OneOver255 = VectorRegsiterConstants::FloatOneOver255;
+	const VectorRegister c0 = VectorMultiply(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Taps01, Zero)), OneOver255);
+	const VectorRegister c1 = VectorMultiply(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Taps01, Zero)), OneOver255);
+	const VectorRegister c2 = VectorMultiply(_mm_cvtepi32_ps(_mm_unpacklo_epi16(Taps23, Zero)), OneOver255);
+	const VectorRegister c3 = VectorMultiply(_mm_cvtepi32_ps(_mm_unpackhi_epi16(Taps23, Zero)), OneOver255);
+
+	// glm::mix(x, y, a) = x * (1 - a) + y * a
+	const VectorRegister tu1 = VectorSetFloat1(tu), tu0 = VectorSetFloat1(1.f - tu);
+	const VectorRegister tv1 = VectorSetFloat1(tv), tv0 = VectorSetFloat1(1.f - tv);
+	const VectorRegister color0 = VectorAdd(VectorMultiply(c0, tu0), VectorMultiply(c1, tu1));
+	const VectorRegister color1 = VectorAdd(VectorMultiply(c2, tu0), VectorMultiply(c3, tu1));
+	const VectorRegister result = VectorAdd(VectorMultiply(color0, tv0), VectorMultiply(color1, tv1));
+
+	VectorStore(result, RGBA);
+	return true;
+}
+
+std::shared_ptr<FSR_Buffer2D> FSR_Texture2D_Swizzled::CreateMipLevel(uint32_t width, uint32_t height) const
+{
+	return std::make_shared<FSR_Texture2D_Swizzled>(width, height);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Helpers
 
-std::shared_ptr<FSR_Buffer2D> FSR_Buffer2D_Helper::CreateBuffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat)
+std::shared_ptr<FSR_Buffer2D> FSR_Buffer2D_Helper::CreateBuffer2D(uint32_t width, uint32_t height, EPixelFormat pixelformat, bool InbTiled)
 {
 	std::shared_ptr<FSR_Buffer2D> buffer2d;
 
 	switch (pixelformat)
 	{
 	case EPixelFormat::PIXEL_FORMAT_U16:
-		buffer2d = std::make_shared<FSR_Buffer2D_U16>(width, height);
+		buffer2d = std::make_shared<FSR_Buffer2D_U16>(width, height, InbTiled);
 		break;
 	case EPixelFormat::PIXEL_FORMAT_F32:
-		buffer2d = std::make_shared<FSR_Buffer2D_F32>(width, height);
+		buffer2d = std::make_shared<FSR_Buffer2D_F32>(width, height, InbTiled);
 		break;
 	case EPixelFormat::PIXEL_FORMAT_RGB888:
-		buffer2d = std::make_shared<FSR_Buffer2D_RGB888>(width, height);
+		buffer2d = std::make_shared<FSR_Buffer2D_RGB888>(width, height, InbTiled);
 		break;
 	case EPixelFormat::PIXEL_FORMAT_RGBA8888:
-		buffer2d = std::make_shared<FSR_Buffer2D_RGBA8888>(width, height);
+		buffer2d = std::make_shared<FSR_Buffer2D_RGBA8888>(width, height, InbTiled);
 		break;
 	case EPixelFormat::PIXEL_FORMAT_RGBF32:
-		buffer2d = std::make_shared<FSR_Buffer2D_RGBF32>(width, height);
+		buffer2d = std::make_shared<FSR_Buffer2D_RGBF32>(width, height, InbTiled);
 		break;
 	case EPixelFormat::PIXEL_FORMAT_RGBAF32:
-		buffer2d = std::make_shared<FSR_Buffer2D_RGBAF32>(width, height);
+		buffer2d = std::make_shared<FSR_Buffer2D_RGBAF32>(width, height, InbTiled);
 		break;
 	default:
 		assert(0 && "unknown pixel format....");
@@ -845,7 +1183,7 @@ std::shared_ptr<FSR_Buffer2D> FSR_Buffer2D_Helper::CreateBuffer2D(uint32_t width
 }
 
 // load & save
-std::shared_ptr<FSR_Buffer2D> FSR_Buffer2D_Helper::LoadImageFile(const char* InFileName)
+std::shared_ptr<FSR_Buffer2D> FSR_Buffer2D_Helper::LoadImageFile(const char* InFileName, EMipFilter InMipFilter)
 {
 	int w, h, channel;
 
@@ -865,12 +1203,33 @@ std::shared_ptr<FSR_Buffer2D> FSR_Buffer2D_Helper::LoadImageFile(const char* InF
 		return nullptr;
 	}
 
-	std::shared_ptr<FSR_Buffer2D> Buffer2d = CreateBuffer2D(w, h, PixelFormat);
-	assert(Buffer2d);
+	std::shared_ptr<FSR_Buffer2D> Buffer2d;
+	if (FSR_Texture2D_Swizzled::IsPowerOfTwo(w) && FSR_Texture2D_Swizzled::IsPowerOfTwo(h))
+	{
+		// swizzle to 4x4 blocks, RGB is expanded to RGBA
+		Buffer2d = std::make_shared<FSR_Texture2D_Swizzled>(w, h);
+		const uint8_t* pSrc = pData;
+		for (int32_t cy = 0; cy < h; ++cy)
+		{
+			uint8_t* pRow = Buffer2d->GetRowData(cy);
+			for (int32_t cx = 0; cx < w; ++cx, pSrc += channel)
+			{
+				const uint8_t RGBA[4] = { pSrc[0], pSrc[1], pSrc[2], channel == 4 ? pSrc[3] : uint8_t(255) };
+				Buffer2d->Write(pRow, cx, RGBA);
+			}
+		}
+	}
+	else
+	{
+		Buffer2d = CreateBuffer2D(w, h, PixelFormat);
+		assert(Buffer2d);
+
+		uint8_t* pDst = Buffer2d->Data();
+		uint32_t nBytes = Buffer2d->Length();
+		memcpy(pDst, pData, nBytes);
+	}
 
-	uint8_t* pDst = Buffer2d->Data();
-	uint32_t nBytes = Buffer2d->Length();
-	memcpy(pDst, pData, nBytes);
+	Buffer2d->GenerateMips(InMipFilter);
 
 	return Buffer2d;
 }
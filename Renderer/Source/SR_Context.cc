@@ -4,6 +4,13 @@
 
 #include "SR_Context.h"
 #include "SR_Renderer.h"
+#include "SR_TileBins.h"
+#include "SR_TileScheduler.h"
+#include "SR_HiZ.h"
+#include "SR_DebugHeatmap.h"
+#include "SR_Arena.h"
+#include "SR_JobSystem.h"
+#include "SR_Trace.h"
 #include "SR_SSE.h"
 
 
@@ -36,12 +43,21 @@ FSR_Context::FSR_Context()
 	: _bEnableMultiThreads(false)
 	, _viewport_rect(0, 0, 1, 1)
 	, _front_face(EFrontFace::FACE_CW)
+	, _depth_func(ECompareFunc::COMPARE_LESS_EQUAL)
+	, _bDepthWrite(true)
+	, _color_write_mask(COLOR_WRITE_ALL)
 	, _bEnableMSAA(false)
 	, _MSAASamplesNum(MSAA_SAMPLES)
+	, _frame_start_microseconds(0.0)
+	, _frame_start_busy_microseconds(0.0)
 {
 	memset(&_pointers_shadow, 0, sizeof(_pointers_shadow));
 
 	_stats = std::make_shared<FSR_Performance>();
+	_worker_stats.resize(1);
+	_tile_bins = std::make_shared<FSR_TileBins>();
+	_tile_scheduler = std::make_shared<FSR_TileScheduler>();
+	_vertex_arena = std::make_shared<FSR_LinearArena>();
 	UpdateMVP();
 }
 
@@ -49,32 +65,42 @@ FSR_Context::~FSR_Context()
 {
 }
 
-void FSR_Context::EnableMultiThreads()
+void FSR_Context::EnableMultiThreads(uint32_t InNumThreads)
 {
-	_bEnableMultiThreads = FSR_Renderer::EnableMultiThreads();
+	_bEnableMultiThreads = FSR_Renderer::EnableMultiThreads(InNumThreads);
 }
 
 // set render target
-void FSR_Context::SetRenderTarget(uint32_t w, uint32_t h, uint32_t nCount, bool InbEnableMSAA)
+void FSR_Context::SetRenderTarget(uint32_t w, uint32_t h, uint32_t nCount, bool InbEnableMSAA, bool InbTiled)
 {
-	_rt_depth = FSR_Buffer2D_Helper::CreateBuffer2D(w, h, EPixelFormat::PIXEL_FORMAT_F32);
+	// pending triangles refer to the old targets
+	FSR_Renderer::Flush(*this);
+	_tile_bins->InvalidateDrawState();
+
+	_rt_depth = FSR_Buffer2D_Helper::CreateBuffer2D(w, h, EPixelFormat::PIXEL_FORMAT_F32, InbTiled);
 	_pointers_shadow._rt_depth = _rt_depth.get();
+	_hiz = std::make_shared<FSR_HiZBuffer>(w, h);
+	_pointers_shadow._hiz = _hiz.get();
+#if SR_ENABLE_DEBUG_HEATMAPS
+	_heatmaps = std::make_shared<FSR_DebugHeatmaps>(w, h);
+	_pointers_shadow._heatmaps = _heatmaps.get();
+#endif
 
 	nCount = std::min<uint32_t>(nCount, MAX_MRT_COUNT);
 	for (uint32_t i=0; i<nCount; ++i)
 	{
-		_rt_colors[i] = FSR_Buffer2D_Helper::CreateBuffer2D(w, h, EPixelFormat::PIXEL_FORMAT_RGBA8888);
+		_rt_colors[i] = FSR_Buffer2D_Helper::CreateBuffer2D(w, h, EPixelFormat::PIXEL_FORMAT_RGBA8888, InbTiled);
 		_pointers_shadow._rt_colors[i] = _rt_colors[i].get();
 	}
 
 	_bEnableMSAA = InbEnableMSAA;
 	if (_bEnableMSAA)
 	{
-		_rt_depth_msaa = FSR_Buffer2D_Helper::CreateBuffer2D(w * _MSAASamplesNum, h, EPixelFormat::PIXEL_FORMAT_F32);
+		_rt_depth_msaa = FSR_Buffer2D_Helper::CreateBuffer2D(w * _MSAASamplesNum, h, EPixelFormat::PIXEL_FORMAT_F32, InbTiled);
 		_pointers_shadow._rt_depth_msaa = _rt_depth_msaa.get();
 		for (uint32_t i = 0; i < nCount; ++i)
 		{
-			_rt_colors_msaa[i] = FSR_Buffer2D_Helper::CreateBuffer2D(w * _MSAASamplesNum, h, EPixelFormat::PIXEL_FORMAT_RGBA8888);
+			_rt_colors_msaa[i] = FSR_Buffer2D_Helper::CreateBuffer2D(w * _MSAASamplesNum, h, EPixelFormat::PIXEL_FORMAT_RGBA8888, InbTiled);
 			_pointers_shadow._rt_colors_msaa[i] = _rt_colors_msaa[i].get();
 		}
 	}
@@ -84,9 +110,12 @@ void FSR_Context::SetRenderTarget(uint32_t w, uint32_t h, uint32_t nCount, bool
 static const float kFloat4One[4] = { 1.f, 1.f, 1.f, 1.f };
 void FSR_Context::ClearRenderTarget(const glm::vec4& InColor)
 {
+	FSR_Renderer::Flush(*this);
+
 	if (_pointers_shadow._rt_depth)
 	{
 		_pointers_shadow._rt_depth->Clear(kFloat4One);
+		_pointers_shadow._hiz->Clear(kFloat4One[0]);
 	}
 	for (uint32_t i = 0; i < MAX_MRT_COUNT; ++i)
 	{
@@ -115,6 +144,30 @@ void FSR_Context::SetCullFaceMode(EFrontFace InMode)
 	_front_face = InMode;
 }
 
+void FSR_Context::SetDepthFunc(ECompareFunc InFunc)
+{
+	_depth_func = InFunc;
+	_tile_bins->InvalidateDrawState();
+}
+
+void FSR_Context::SetDepthWrite(bool InbEnable)
+{
+	_bDepthWrite = InbEnable;
+	_tile_bins->InvalidateDrawState();
+}
+
+void FSR_Context::SetColorWriteMask(uint32_t InMask)
+{
+	_color_write_mask = InMask & COLOR_WRITE_ALL;
+	_tile_bins->InvalidateDrawState();
+}
+
+void FSR_Context::SetTileSizeRange(uint32_t InMinSize, uint32_t InMaxSize)
+{
+	// takes effect at the next flush
+	_tile_scheduler->SetSizeRange(InMinSize, InMaxSize);
+}
+
 void FSR_Context::SetViewport(uint32_t x, uint32_t y, uint32_t w, uint32_t h)
 {
 	_viewport_rect._minx = static_cast<float>(x);
@@ -130,6 +183,7 @@ void FSR_Context::SetModelViewMatrix(const glm::mat4x4& InModelView)
 	_mvps._modelview_inv_t = glm::transpose(_mvps._modelview_inv);
 
 	UpdateMVP();
+	_tile_bins->InvalidateDrawState();
 }
 
 // set projection matrix
@@ -139,6 +193,7 @@ void FSR_Context::SetProjectionMatrix(const glm::mat4x4& InProj)
 	_mvps._projection_inv = glm::inverse(InProj);
 
 	UpdateMVP();
+	_tile_bins->InvalidateDrawState();
 }
 
 void FSR_Context::UpdateMVP()
@@ -152,6 +207,7 @@ void FSR_Context::SetMaterial(const std::shared_ptr<FSR_Material>& InMaterial)
 { 
 	_material = InMaterial; 
 	_pointers_shadow._material = _material.get();
+	_tile_bins->InvalidateDrawState();
 }
 
 //set pipeline
@@ -162,6 +218,7 @@ void FSR_Context::SetShader(const std::shared_ptr<FSR_VertexShader>& InVs, const
 
 	_pointers_shadow._vs = _vs.get();
 	_pointers_shadow._ps = _ps.get();
+	_tile_bins->InvalidateDrawState();
 }
 
 std::shared_ptr<FSR_Buffer2D> FSR_Context::GetDepthBuffer() const
@@ -191,17 +248,53 @@ std::shared_ptr<FSR_Buffer2D> FSR_Context::GetMSAAColorBuffer(uint32_t InIndex)
 
 void FSR_Context::BeginFrame()
 {
+	_tile_scheduler->BeginFrame();
 #if SR_ENABLE_PERFORMACE_STAT
 	if (_stats) {
 		_stats->Reset();
 	}
+	for (FSR_WorkerStats& Worker : _worker_stats)
+	{
+		Worker.Reset();
+	}
+	_frame_start_busy_microseconds = FSR_JobSystem::sharedInstance().WorkersBusyMicroseconds();
+#endif
+#if SR_ENABLE_PERFORMACE_STAT || SR_ENABLE_TRACE
+	_frame_start_microseconds = appMicroSeconds();
+#endif
+#if SR_ENABLE_DEBUG_HEATMAPS
+	if (_heatmaps) {
+		_heatmaps->Clear();
+	}
 #endif
 }
 
 void FSR_Context::EndFrame()
 {
+	SR_TRACE_SCOPE("EndFrame");
 	FSR_Renderer::Flush(*this);
 	ResolveMSAABuffer();
+
+#if SR_ENABLE_PERFORMACE_STAT
+	// no job is running after the flush
+	for (const FSR_WorkerStats& Worker : _worker_stats)
+	{
+		_stats->Accumulate(Worker);
+	}
+	const FSR_JobSystem& JobSystem = FSR_JobSystem::sharedInstance();
+	const double FrameMicroseconds = appMicroSeconds() - _frame_start_microseconds;
+	_stats->_worker_busy_microseconds = JobSystem.WorkersBusyMicroseconds() - _frame_start_busy_microseconds;
+	_stats->_worker_idle_microseconds = std::max(0.0, FrameMicroseconds * JobSystem.NumWorkers() - _stats->_worker_busy_microseconds);
+#endif
+
+#if SR_ENABLE_TRACE
+	// the frame spans BeginFrame to here
+	FSR_Trace& Trace = FSR_Trace::sharedInstance();
+	if (Trace.IsCapturing())
+	{
+		Trace.ThreadBuffer().Push({ "Frame", _frame_start_microseconds, appMicroSeconds() - _frame_start_microseconds, SR_INVALID_INDEX });
+	}
+#endif
 }
 
 void FSR_Context::ResolveMSAABuffer()
@@ -210,6 +303,7 @@ void FSR_Context::ResolveMSAABuffer()
 	{
 		return;
 	}
+	SR_TRACE_SCOPE("ResolveMSAABuffer");
 
 	assert(_pointers_shadow._rt_depth && _pointers_shadow._rt_depth_msaa);
 	const uint32_t w = _pointers_shadow._rt_depth->Width();
@@ -242,7 +336,7 @@ void FSR_Context::ResolveMSAABuffer()
 			{
 				for (uint32_t cx = 0, msaa_cx = 0; cx < w; ++cx, msaa_cx += _MSAASamplesNum)
 				{
-					float RGBA[4];
+					float RGBA[4] = { 0.f, 0.f, 0.f, 0.f };
 					float rgba[4];
 					for (int32_t i = 0; i < _MSAASamplesNum; ++i)
 					{
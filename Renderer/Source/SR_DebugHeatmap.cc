@@ -0,0 +1,108 @@
+// \brief
+//	debug heatmaps of the tile rasterizer.
+//
+
+#include <iostream>
+#include <string>
+#include "SR_DebugHeatmap.h"
+
+
+FSR_DebugHeatmaps::FSR_DebugHeatmaps(uint32_t w, uint32_t h)
+	: _w(w)
+	, _h(h)
+	, _pixels(size_t(w) * h)
+{
+	Clear();
+}
+
+void FSR_DebugHeatmaps::Clear()
+{
+	std::fill(_pixels.begin(), _pixels.end(), FPixelCounters{ 0, 0, 0, 0 });
+}
+
+void FSR_DebugHeatmaps::AddTileCycles(int32_t X0, int32_t Y0, int32_t X1, int32_t Y1, uint64_t InCycles)
+{
+	X1 = std::min(X1, _w);
+	Y1 = std::min(Y1, _h);
+	for (int32_t y = Y0; y < Y1; ++y)
+	{
+		FPixelCounters* pixels = &_pixels[y * _w];
+		for (int32_t x = X0; x < X1; ++x)
+		{
+			pixels[x]._tile_cycles += InCycles;
+		}
+	}
+}
+
+double FSR_DebugHeatmaps::GetValue(EDebugHeatmap InKind, uint32_t InIndex) const
+{
+	const FPixelCounters& pixel = _pixels[InIndex];
+	switch (InKind)
+	{
+	case EDebugHeatmap::HEATMAP_OVERDRAW: return pixel._shaded;
+	case EDebugHeatmap::HEATMAP_DEPTH_COMPLEXITY: return pixel._depth_tests;
+	case EDebugHeatmap::HEATMAP_DEPTH_FAIL: return pixel._depth_fails;
+	case EDebugHeatmap::HEATMAP_TILE_LOAD: return static_cast<double>(pixel._tile_cycles);
+	default:
+		return 0.0;
+	}
+}
+
+// black, blue, cyan, green, yellow, red
+static void HeatColor(float t, float OutRGBA[4])
+{
+	static const float kStops[][3] = {
+		{ 0.f, 0.f, 0.f }, { 0.f, 0.f, 1.f }, { 0.f, 1.f, 1.f }, { 0.f, 1.f, 0.f }, { 1.f, 1.f, 0.f }, { 1.f, 0.f, 0.f } };
+	const int32_t kLast = static_cast<int32_t>(SR_ARRAY_COUNT(kStops)) - 1;
+
+	const float s = std::min(std::max(t, 0.f), 1.f) * kLast;
+	const int32_t k = std::min(static_cast<int32_t>(s), kLast - 1);
+	const float f = s - k;
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		OutRGBA[i] = kStops[k][i] + (kStops[k + 1][i] - kStops[k][i]) * f;
+	}
+	OutRGBA[3] = 1.f;
+}
+
+std::shared_ptr<FSR_Buffer2D> FSR_DebugHeatmaps::CreateImage(EDebugHeatmap InKind, double* OutMaxValue) const
+{
+	double MaxValue = 0.0;
+	for (uint32_t k = 0; k < _pixels.size(); ++k)
+	{
+		MaxValue = std::max(MaxValue, GetValue(InKind, k));
+	}
+	if (OutMaxValue)
+	{
+		*OutMaxValue = MaxValue;
+	}
+
+	std::shared_ptr<FSR_Buffer2D> Image = FSR_Buffer2D_Helper::CreateBuffer2D(_w, _h, EPixelFormat::PIXEL_FORMAT_RGBA8888);
+	const double Scale = MaxValue > 0.0 ? 1.0 / MaxValue : 0.0;
+	for (int32_t y = 0; y < _h; ++y)
+	{
+		for (int32_t x = 0; x < _w; ++x)
+		{
+			float RGBA[4];
+			HeatColor(static_cast<float>(GetValue(InKind, y * _w + x) * Scale), RGBA);
+			Image->Write(x, y, RGBA);
+		}
+	}
+	return Image;
+}
+
+bool FSR_DebugHeatmaps::SaveImages(const char* InPrefix) const
+{
+	static const char* kNames[] = { "overdraw", "depth_complexity", "depth_fail", "tile_load" };
+	static_assert(SR_ARRAY_COUNT(kNames) == static_cast<size_t>(EDebugHeatmap::HEATMAP_COUNT), "a name per heatmap");
+
+	bool bSaved = true;
+	for (uint32_t k = 0; k < SR_ARRAY_COUNT(kNames); ++k)
+	{
+		double MaxValue = 0.0;
+		const std::string Filename = std::string(InPrefix) + "_" + kNames[k] + ".png";
+		bSaved &= FSR_Buffer2D_Helper::SaveImageFile(CreateImage(static_cast<EDebugHeatmap>(k), &MaxValue), Filename.c_str());
+		std::cerr << Filename << ": red = " << MaxValue << std::endl;
+	}
+	return bSaved;
+}
@@ -0,0 +1,96 @@
+// \brief
+//		hierarchical z-buffer
+//
+
+#include "SR_HiZ.h"
+#include <cfloat>
+
+
+FSR_HiZBuffer::FSR_HiZBuffer(uint32_t w, uint32_t h)
+	: _w(w)
+	, _h(h)
+{
+	_blocks_x = (_w + SR_HIZ_BLOCK_SIZE - 1) / SR_HIZ_BLOCK_SIZE;
+	_blocks_y = (_h + SR_HIZ_BLOCK_SIZE - 1) / SR_HIZ_BLOCK_SIZE;
+	_cells_x = (_w + SR_HIZ_CELL_SIZE - 1) / SR_HIZ_CELL_SIZE;
+	_cells_y = (_h + SR_HIZ_CELL_SIZE - 1) / SR_HIZ_CELL_SIZE;
+
+	_blocks.resize(_blocks_x * _blocks_y);
+	_cells.resize(_cells_x * _cells_y);
+	Clear(1.f);
+}
+
+void FSR_HiZBuffer::Clear(float InDepth)
+{
+	for (int32_t by = 0; by < _blocks_y; ++by)
+	{
+		for (int32_t bx = 0; bx < _blocks_x; ++bx)
+		{
+			FBlock& block = _blocks[by * _blocks_x + bx];
+			block._max = InDepth;
+			ResetBlock(block, bx, by);
+		}
+	}
+	std::fill(_cells.begin(), _cells.end(), InDepth);
+}
+
+void FSR_HiZBuffer::ResetBlock(FBlock& OutBlock, int32_t InBlockX, int32_t InBlockY) const
+{
+	const int32_t columns = std::min(SR_HIZ_BLOCK_SIZE, _w - InBlockX * SR_HIZ_BLOCK_SIZE);
+	const int32_t rows = std::min(SR_HIZ_BLOCK_SIZE, _h - InBlockY * SR_HIZ_BLOCK_SIZE);
+
+	uint64_t inside = 0;
+	for (int32_t r = 0; r < rows; ++r)
+	{
+		inside |= ((1ull << columns) - 1) << (r * SR_HIZ_BLOCK_SIZE);
+	}
+
+	OutBlock._pending_max = -FLT_MAX;
+	OutBlock._mask = ~inside;
+}
+
+float FSR_HiZBuffer::GetMaxDepth(int32_t X0, int32_t Y0, int32_t X1, int32_t Y1) const
+{
+	assert(X0 < X1 && Y0 < Y1);
+
+	const int32_t cx1 = std::min(_cells_x - 1, (X1 - 1) / SR_HIZ_CELL_SIZE);
+	const int32_t cy1 = std::min(_cells_y - 1, (Y1 - 1) / SR_HIZ_CELL_SIZE);
+
+	float max_depth = -FLT_MAX;
+	for (int32_t cy = Y0 / SR_HIZ_CELL_SIZE; cy <= cy1; ++cy)
+	{
+		for (int32_t cx = X0 / SR_HIZ_CELL_SIZE; cx <= cx1; ++cx)
+		{
+			max_depth = std::max(max_depth, _cells[cy * _cells_x + cx]);
+		}
+	}
+	return max_depth;
+}
+
+void FSR_HiZBuffer::UpdateCells(int32_t X0, int32_t Y0, int32_t X1, int32_t Y1)
+{
+	assert(X0 < X1 && Y0 < Y1);
+
+	const int32_t kBlocksPerCell = SR_HIZ_CELL_SIZE / SR_HIZ_BLOCK_SIZE;
+	const int32_t cx1 = std::min(_cells_x - 1, (X1 - 1) / SR_HIZ_CELL_SIZE);
+	const int32_t cy1 = std::min(_cells_y - 1, (Y1 - 1) / SR_HIZ_CELL_SIZE);
+
+	for (int32_t cy = Y0 / SR_HIZ_CELL_SIZE; cy <= cy1; ++cy)
+	{
+		for (int32_t cx = X0 / SR_HIZ_CELL_SIZE; cx <= cx1; ++cx)
+		{
+			const int32_t bx1 = std::min(_blocks_x, (cx + 1) * kBlocksPerCell);
+			const int32_t by1 = std::min(_blocks_y, (cy + 1) * kBlocksPerCell);
+
+			float max_depth = -FLT_MAX;
+			for (int32_t by = cy * kBlocksPerCell; by < by1; ++by)
+			{
+				for (int32_t bx = cx * kBlocksPerCell; bx < bx1; ++bx)
+				{
+					max_depth = std::max(max_depth, _blocks[by * _blocks_x + bx]._max);
+				}
+			}
+			_cells[cy * _cells_x + cx] = max_depth;
+		}
+	}
+}
@@ -0,0 +1,267 @@
+// \brief
+//	work-stealing job system.
+//
+
+#include <cstdio>
+#include "SR_JobSystem.h"
+#include "SR_Performance.h"
+#include "SR_Trace.h"
+#include <emmintrin.h> // _mm_pause
+
+
+static thread_local uint32_t GThreadSlot = 0;
+
+
+FSR_JobSystem& FSR_JobSystem::sharedInstance()
+{
+	static FSR_JobSystem shared;
+
+	return shared;
+}
+
+FSR_JobSystem::FSR_JobSystem()
+	: _next_ring(0)
+	, _queued(0)
+	, _pending(0)
+	, _sleepers(0)
+	, _waiting(false)
+	, _terminate(false)
+{
+}
+
+FSR_JobSystem::~FSR_JobSystem()
+{
+	Terminate();
+}
+
+bool FSR_JobSystem::Start(uint32_t InNumWorkers)
+{
+	if (IsRunning())
+	{
+		return true;
+	}
+
+	// the calling thread runs jobs too (slot 0) while it waits
+	if (InNumWorkers == 0)
+	{
+		InNumWorkers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+	}
+
+	_terminate = false;
+	_slot_times.assign(InNumWorkers + 1, FSlotTimes{ 0.0 });
+	_rings.resize(InNumWorkers);
+	for (uint32_t k = 0; k < InNumWorkers; ++k)
+	{
+		_rings[k].reset(new FSR_JobRing);
+	}
+	for (uint32_t k = 0; k < InNumWorkers; ++k)
+	{
+		_workers.emplace_back(&FSR_JobSystem::WorkerLoop, this, k);
+	}
+	return true;
+}
+
+void FSR_JobSystem::Terminate()
+{
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	Wait();
+	{
+		std::unique_lock<std::mutex> lock(_wake_mutex);
+		_terminate = true;
+	}
+	_wake_cv.notify_all();
+
+	for (std::thread& worker : _workers)
+	{
+		worker.join();
+	}
+	_workers.clear();
+	_rings.clear();
+}
+
+uint32_t FSR_JobSystem::ThreadSlot()
+{
+	return GThreadSlot;
+}
+
+double FSR_JobSystem::WorkersBusyMicroseconds() const
+{
+	double busy = 0.0;
+	for (size_t k = 1; k < _slot_times.size(); ++k)
+	{
+		busy += _slot_times[k]._busy_microseconds;
+	}
+	return busy;
+}
+
+void FSR_JobSystem::Dispatch(pfnSRJob InFunc, void* InData, uint32_t InCount)
+{
+	assert(IsRunning());
+	if (InCount == 0)
+	{
+		return;
+	}
+
+	_pending += InCount;
+
+	// round-robin, neighbour jobs go to different workers
+	const uint32_t num_rings = static_cast<uint32_t>(_rings.size());
+	uint32_t overflow = InCount;
+	for (uint32_t k = 0; k < InCount; ++k)
+	{
+		FSR_JobRing& ring = *_rings[_next_ring];
+		_next_ring = (_next_ring + 1) % num_rings;
+
+		if (!ring.Stage({ InFunc, InData, k }))
+		{
+			overflow = k;
+			break;
+		}
+	}
+
+	// publish once per ring
+	int32_t published = 0;
+	for (uint32_t k = 0; k < num_rings; ++k)
+	{
+		published += _rings[k]->Publish();
+	}
+
+	_queued += published;
+	if (_sleepers > 0)
+	{
+		std::unique_lock<std::mutex> lock(_wake_mutex);
+		_wake_cv.notify_all();
+	}
+
+	// rings are full, run the rest here
+	for (uint32_t k = overflow; k < InCount; ++k)
+	{
+		Execute({ InFunc, InData, k });
+	}
+}
+
+void FSR_JobSystem::Wait()
+{
+	FSR_Job job;
+	uint32_t spin = 0;
+
+	while (_pending > 0)
+	{
+		if (FetchJob(0, job))
+		{
+			Execute(job);
+			spin = 0;
+			continue;
+		}
+
+		// remaining jobs are running on workers
+		if (++spin < SR_JOB_SPIN_COUNT)
+		{
+			_mm_pause();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_done_mutex);
+		_waiting = true;
+		_done_cv.wait(lock, [this] { return _pending == 0; });
+		_waiting = false;
+	}
+}
+
+void FSR_JobSystem::ParallelFor(pfnSRJob InFunc, void* InData, uint32_t InCount)
+{
+	if (!IsRunning())
+	{
+		for (uint32_t k = 0; k < InCount; ++k)
+		{
+			InFunc(InData, k);
+		}
+		return;
+	}
+
+	Dispatch(InFunc, InData, InCount);
+	Wait();
+}
+
+void FSR_JobSystem::WorkerLoop(uint32_t InWorkerIndex)
+{
+	FSR_Job job;
+	uint32_t spin = 0;
+
+	GThreadSlot = InWorkerIndex + 1;
+#if SR_ENABLE_TRACE
+	char name[32];
+	snprintf(name, sizeof(name), "SR Worker %u", InWorkerIndex);
+	SR_TRACE_THREAD_NAME(name);
+#endif
+	while (1)
+	{
+		if (FetchJob(InWorkerIndex, job))
+		{
+			Execute(job);
+			spin = 0;
+			continue;
+		}
+
+		if (++spin < SR_JOB_SPIN_COUNT)
+		{
+			if (_queued <= 0)
+			{
+				_mm_pause();
+			}
+			continue;
+		}
+
+		// park, Dispatch() wakes up the sleepers
+		std::unique_lock<std::mutex> lock(_wake_mutex);
+		++_sleepers;
+		_wake_cv.wait(lock, [this] { return _terminate || _queued > 0; });
+		--_sleepers;
+		if (_terminate)
+		{
+			break;
+		}
+		spin = 0;
+	}
+}
+
+bool FSR_JobSystem::FetchJob(uint32_t InWorkerIndex, FSR_Job& OutJob)
+{
+	const uint32_t num_rings = static_cast<uint32_t>(_rings.size());
+
+	// own ring first, then steal from others
+	for (uint32_t k = 0; k < num_rings; ++k)
+	{
+		if (_rings[(InWorkerIndex + k) % num_rings]->Pop(OutJob))
+		{
+			--_queued;
+			return true;
+		}
+	}
+	return false;
+}
+
+void FSR_JobSystem::Execute(const FSR_Job& InJob)
+{
+#if SR_ENABLE_PERFORMACE_STAT
+	FPerformanceCounter PerfCounter;
+	PerfCounter.StartPerf();
+#endif
+
+	InJob._func(InJob._data, InJob._index);
+
+#if SR_ENABLE_PERFORMACE_STAT
+	// before the job is retired, Wait() makes it visible to the dispatching thread
+	_slot_times[GThreadSlot]._busy_microseconds += PerfCounter.EndPerf();
+#endif
+
+	if (--_pending == 0 && _waiting)
+	{
+		std::unique_lock<std::mutex> lock(_done_mutex);
+		_done_cv.notify_all();
+	}
+}
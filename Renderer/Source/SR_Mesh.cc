@@ -4,6 +4,7 @@
 
 #include <map>
 #include <string>
+#include <cstring>
 
 #include "SR_Mesh.h"
 #include "tiny_obj_loader.h"
@@ -15,6 +16,42 @@ void FSR_Mesh::Purge()
 	_IndexBuffer.clear();
 	_Materials.clear();
 	_SubMeshes.clear();
+	for (std::vector<float>& stream : _PositionStreams)
+	{
+		stream.clear();
+	}
+}
+
+void FSR_Mesh::BuildPositionStreams()
+{
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		_PositionStreams[i].resize(_VertexBuffer.size());
+		for (size_t k = 0; k < _VertexBuffer.size(); ++k)
+		{
+			_PositionStreams[i][k] = _VertexBuffer[k]._vertex[i];
+		}
+	}
+}
+
+bool FSR_Mesh::PositionStreamsMatch() const
+{
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		if (_PositionStreams[i].size() != _VertexBuffer.size())
+		{
+			return false;
+		}
+		for (size_t k = 0; k < _VertexBuffer.size(); ++k)
+		{
+			// bitwise, NaN positions are copied as well
+			if (memcmp(&_PositionStreams[i][k], &_VertexBuffer[k]._vertex[i], sizeof(float)) != 0)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
 }
 
 bool FSR_Mesh::LoadFromObjFile(const char* fileName, const char* mtlBaseDir)
@@ -169,11 +206,13 @@ bool FSR_Mesh::LoadFromObjFile(const char* fileName, const char* mtlBaseDir)
 			// sort by material
 			std::sort(_SubMeshes.begin(), _SubMeshes.end(), [](const FSR_SubMesh& lhs, const FSR_SubMesh& rhs) -> bool { return lhs._MaterialIndex < rhs._MaterialIndex; });
 		}
+
+		BuildPositionStreams();
 	}
 	else
 	{
+		// the caller decides, e.g. a demo scene without its assets
 		printf("ERROR: %s\n", err.c_str());
-		assert(false && "Failed to load .OBJ file, check file paths!");
 		return false;
 	}
 
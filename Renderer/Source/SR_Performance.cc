@@ -1,13 +1,23 @@
 // // \brief
-//		Time Query On Windows Platform.
+//		Time Query: QueryPerformanceCounter on Windows,
+//		calibrated RDTSC or clock_gettime(CLOCK_MONOTONIC_RAW) elsewhere.
 //
 
-#include <Windows.h>
 #include "SR_Performance.h"
 
+#if defined(_WIN32)
+#include <Windows.h>
+#else
+#include <time.h>
+#if SR_TIMING_USE_RDTSC
+#include <x86intrin.h>
+#include <cpuid.h>
+#endif
+#endif
+
 
 static double GSecondsPerCycle = 0.0;
-static LARGE_INTEGER GFrequency = { 0, 0 };
+static double GMicroSecondsPerCycle = 0.0;
 
 class FTimerInitializer
 {
@@ -17,34 +27,105 @@ public:
 		appInitTiming();
 	}
 };
-static FTimerInitializer timer_init;
+
+#if defined(_WIN32)
 
 double appInitTiming()
 {
-	QueryPerformanceFrequency(&GFrequency);
-	GSecondsPerCycle = 1.0 / GFrequency.QuadPart;
+	LARGE_INTEGER Frequency;
+	QueryPerformanceFrequency(&Frequency);
+	GSecondsPerCycle = 1.0 / Frequency.QuadPart;
+	GMicroSecondsPerCycle = 1000000.0 / Frequency.QuadPart;
 
 	return appSeconds();
 }
 
-double appSeconds()
+int64_t appCycles()
 {
 	LARGE_INTEGER Cycles;
 	QueryPerformanceCounter(&Cycles);
-	return Cycles.QuadPart * GSecondsPerCycle;
+	return Cycles.QuadPart;
 }
 
-double appMicroSeconds()
+#else
+
+static inline int64_t MonotonicNanoSeconds()
 {
-	LARGE_INTEGER Cycles;
-	QueryPerformanceCounter(&Cycles);
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+#if SR_TIMING_USE_RDTSC
+// the tsc only counts wall time when it is invariant
+static bool GUseTSC = false;
+
+static bool IsInvariantTSC()
+{
+	uint32_t eax, ebx, ecx, edx;
+	if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007)
+	{
+		return false;
+	}
+	__cpuid(0x80000007, eax, ebx, ecx, edx);
+	return (edx & (1u << 8)) != 0;
+}
+
+// measure the tsc rate against the monotonic clock
+static double CalibrateTSC()
+{
+	const int64_t kCalibrateNanoSeconds = 20000000; // 20ms
 
-	return (Cycles.QuadPart * 1000000.0) / GFrequency.QuadPart;
+	const int64_t StartNs = MonotonicNanoSeconds();
+	const uint64_t StartTSC = __rdtsc();
+	int64_t EndNs;
+	do
+	{
+		EndNs = MonotonicNanoSeconds();
+	} while (EndNs - StartNs < kCalibrateNanoSeconds);
+	const uint64_t EndTSC = __rdtsc();
+
+	return double(EndTSC - StartTSC) * 1000000000.0 / double(EndNs - StartNs);
+}
+#endif
+
+double appInitTiming()
+{
+	double Frequency = 1000000000.0; // nanoseconds of the monotonic clock
+#if SR_TIMING_USE_RDTSC
+	GUseTSC = IsInvariantTSC();
+	if (GUseTSC)
+	{
+		Frequency = CalibrateTSC();
+	}
+#endif
+	GSecondsPerCycle = 1.0 / Frequency;
+	GMicroSecondsPerCycle = 1000000.0 / Frequency;
+
+	return appSeconds();
 }
 
 int64_t appCycles()
 {
-	LARGE_INTEGER Cycles;
-	QueryPerformanceCounter(&Cycles);
-	return Cycles.QuadPart;
+#if SR_TIMING_USE_RDTSC
+	if (GUseTSC)
+	{
+		return static_cast<int64_t>(__rdtsc());
+	}
+#endif
+	return MonotonicNanoSeconds();
+}
+
+#endif
+
+static FTimerInitializer timer_init;
+
+double appSeconds()
+{
+	return appCycles() * GSecondsPerCycle;
+}
+
+double appMicroSeconds()
+{
+	return appCycles() * GMicroSecondsPerCycle;
 }
@@ -63,8 +63,17 @@
 */
 
 #include <algorithm>
+#include <cfloat>
 #include "SR_Renderer.h"
+#include "SR_TileBins.h"
+#include "SR_TileScheduler.h"
+#include "SR_HiZ.h"
+#include "SR_DebugHeatmap.h"
+#include "SR_PixelAccess.h"
+#include "SR_JobSystem.h"
+#include "SR_Trace.h"
 #include "SR_SSE.h"
+#include "SR_SIMD.h"
 
 
 static const glm::vec4 kClipPlanes[] =
@@ -193,16 +202,6 @@ static uint32_t ClipAgainstPlane(const FSRVertexShaderOutput InVerts[], const ui
 }
 
 
-// https://www.scratchapixel.com/lessons/3d-basic-rendering/rasterization-practical-implementation/rasterization-stage
-// https://www.scratchapixel.com/lessons/3d-basic-rendering/rasterization-practical-implementation/visibility-problem-depth-buffer-depth-interpolation
-// https://www.scratchapixel.com/lessons/3d-basic-rendering/rasterization-practical-implementation/perspective-correct-interpolation-vertex-attributes
-struct FSR_RasterizedVert
-{
-	glm::vec3	_ndc_pos;
-	glm::vec3	_screen_pos;
-	float		_inv_w;
-};
-
 static bool intersect(const FSR_Rectangle& InA, const FSR_Rectangle& InB, FSR_Rectangle& Out)
 {
 	float minx = std::max(InA._minx, InB._minx);
@@ -269,481 +268,653 @@ inline FSR_Rectangle BoundingboxOfTriangle(const glm::vec3& V0, const glm::vec3&
 }
 
 
-inline void DivideVertexAttributesByW(const FSRVertexAttributes& VInput, float InOneOverW, FSRVertexAttributes& PInput)
+inline void DivideVertexAttributesByW(const FSRVertexAttributes& VInput, float InOneOverW, glm::vec4* POutput)
 {
 #if 0
 	for (uint32_t k = 0; k < VInput._count; ++k)
 	{
-		PInput._members[k] = VInput._members[k] * InOneOverW;
+		POutput[k] = VInput._members[k] * InOneOverW;
 	}
-	PInput._count = VInput._count;
 #else
 	VectorRegister regOneOverW = VectorSetFloat1(InOneOverW);
 	for (uint32_t k = 0; k < VInput._count; ++k)
 	{
 		VectorRegister Value = VectorLoad(&(VInput._members[k].x));
 		VectorRegister Result = VectorMultiply(Value, regOneOverW);
-		VectorStore(Result, &(PInput._members[k].x));
+		VectorStore(Result, &(POutput[k].x));
 	}
-	PInput._count = VInput._count;
 #endif
 }
 
-inline void InterpolateVertexAttributes(const FSRVertexAttributes& V0, float w0,
-	const FSRVertexAttributes& V1, float w1,
-	const FSRVertexAttributes& V2, float w2,
-	float W,
-	FSRVertexAttributes& Output)
+
+
+//////////////////////////////////////////////////////////////
+/// Tiled Rendering
+///
+
+// block size of the hierarchical rasterizer, at most 32 (row mask bits)
+#define SR_RASTER_BLOCK_SIZE	8
+static_assert(SR_RASTER_BLOCK_SIZE == SR_HIZ_BLOCK_SIZE, "the HiZ is updated per raster block");
+
+// depth test
+inline bool DepthCompare(ECompareFunc InFunc, float InDepth, float InPrevDepth)
 {
-#if 0 // before optimize
-	for (uint32_t k = 0; k < V0._count; ++k)
+	switch (InFunc)
 	{
-		Output._members[k] = (V0._members[k] * w0 +
-			V1._members[k] * w1 +
-			V2._members[k] * w2) * W;
+	case ECompareFunc::COMPARE_NEVER:			return false;
+	case ECompareFunc::COMPARE_LESS:			return InDepth < InPrevDepth;
+	case ECompareFunc::COMPARE_EQUAL:			return InDepth == InPrevDepth;
+	case ECompareFunc::COMPARE_LESS_EQUAL:		return InDepth <= InPrevDepth;
+	case ECompareFunc::COMPARE_GREATER:			return InDepth > InPrevDepth;
+	case ECompareFunc::COMPARE_NOT_EQUAL:		return InDepth != InPrevDepth;
+	case ECompareFunc::COMPARE_GREATER_EQUAL:	return InDepth >= InPrevDepth;
+	default:									return true;
 	}
-#else
+}
 
-	VectorRegister RW012 = VectorSetFloat3(w0, w1, w2);
-	VectorRegister RW = VectorSetFloat1(W);
-	VectorRegister RWW = VectorMultiply(RW012, RW);
+// write the channels of InWriteMask
+template <EPixelFormat ColorFormat>
+inline void WriteColor(FSR_Texture2D* rt, uint8_t* pRow, uint32_t cx, const glm::vec4& InColor, uint32_t InWriteMask)
+{
+	typedef TSR_PixelAccess<ColorFormat> FColorAccess;
 
-	for (uint32_t k = 0; k < V0._count; ++k)
+	if (InWriteMask == COLOR_WRITE_ALL)
 	{
-		const glm::vec4& a = V0._members[k];
-		const glm::vec4& b = V1._members[k];
-		const glm::vec4& c = V2._members[k];
-		glm::vec4& o = Output._members[k];
-
-		/*
-			o.x = (a.x * w0 + b.x * w1 + c.x * w2) * W;
-			o.y = (a.y * w0 + b.y * w1 + c.y * w2) * W;
-			o.z = (a.z * w0 + b.z * w1 + c.z * w2) * W;
-			o.w = (a.w * w0 + b.w * w1 + c.w * w2) * W;
-		*/
-		VectorRegister RX = VectorSetFloat3(a.x, b.x, c.x);
-		VectorRegister RY = VectorSetFloat3(a.y, b.y, c.y);
-		VectorRegister RZ = VectorSetFloat3(a.z, b.z, c.z);
-		VectorRegister RW = VectorSetFloat3(a.w, b.w, c.w);
-
-		VectorRegister RXdot = VectorDot3(RX, RWW);
-		VectorRegister RYdot = VectorDot3(RY, RWW);
-		VectorRegister RZdot = VectorDot3(RZ, RWW);
-		VectorRegister RWdot = VectorDot3(RW, RWW);
-
-		o.x = VectorGetComponent(RXdot, 0);
-		o.y = VectorGetComponent(RYdot, 0);
-		o.z = VectorGetComponent(RZdot, 0);
-		o.w = VectorGetComponent(RWdot, 0);
+		FColorAccess::WriteColor(rt, pRow, cx, &InColor.r);
+		return;
 	}
-#endif
+
+	float RGBA[4];
+	FColorAccess::ReadColor(rt, pRow, cx, RGBA);
+	for (int32_t c = 0; c < 4; ++c)
+	{
+		if (InWriteMask & (1 << c))
+		{
+			RGBA[c] = InColor[c];
+		}
+	}
+	FColorAccess::WriteColor(rt, pRow, cx, RGBA);
 }
 
+// edge function of the sub-pixel position (PX, PY), exact
+inline int64_t EvaluateEdge(const FTiledRenderingContext& InCtx, int32_t e, int64_t PX, int64_t PY)
+{
+	return InCtx._EdgeA[e] * PX + InCtx._EdgeB[e] * PY + InCtx._EdgeC[e];
+}
 
+// quads side by side from (gx, gy), see FSRPixelShaderWideInput
+#define SR_WIDE_QUADS	(SR_SIMD_WIDTH / 4)
 
-//////////////////////////////////////////////////////////////
-/// Tiled Rendering
-///
-struct FTiledRenderingContext
+// per-lane steps of the 1/w & attribute / w planes, from the first pixel of a lane group.
+// a lane is then one add per component & the perspective divide.
+struct FWidePlaneSteps
 {
-	const FSR_Context* _SRCtx;
-	FSR_Context::FPointersShadow _Pointers;
-	FSRPixelShaderContext _psCtx;
+	alignas(32) float _inv_w[SR_SIMD_WIDTH];
+	alignas(32) float _attributes[MAX_ATTRIBUTES_COUNT][4][SR_SIMD_WIDTH];
+};
 
-	/* triangle info */
-	float _kOneOverE012;
-	FSR_RasterizedVert _SV0, _SV1, _SV2;
-	FSRVertexAttributes _VA0, _VA1, _VA2;
+inline void SetupWidePlaneSteps(const FTiledRenderingContext& InCtx, FWidePlaneSteps& Steps)
+{
+	alignas(32) float LaneX[SR_SIMD_WIDTH];
+	alignas(32) float LaneY[SR_SIMD_WIDTH];
+	for (int32_t l = 0; l < SR_SIMD_WIDTH; ++l)
+	{
+		LaneX[l] = static_cast<float>(((l >> 2) << 1) + (l & 1));
+		LaneY[l] = static_cast<float>((l >> 1) & 1);
+	}
+	const VectorRegisterWide RegX = WideLoad(LaneX);
+	const VectorRegisterWide RegY = WideLoad(LaneY);
 
-	/* tile info */
-	int32_t _X0, _Y0, _X1, _Y1;
-};
+	WideStore(WideMultiplyAdd(WideSet1(InCtx._InvWPlane[2]), RegY, WideMultiply(WideSet1(InCtx._InvWPlane[1]), RegX)), Steps._inv_w);
+	for (uint32_t k = 0; k < InCtx._AttributeCount; ++k)
+	{
+		const glm::vec4* Plane = InCtx.AttributePlane(k);
+		for (int32_t i = 0; i < 4; ++i)
+		{
+			WideStore(WideMultiplyAdd(WideSet1(Plane[2][i]), RegY, WideMultiply(WideSet1(Plane[1][i]), RegX)), Steps._attributes[k][i]);
+		}
+	}
+}
 
-static void RasterizeTriangleNormal_Tile(const FTiledRenderingContext &InCtx)
+// perspective correct attributes of the SR_SIMD_WIDTH pixel centers from (gx, gy), in SoA.
+// helper pixels outside of the triangle are extrapolated on the same planes.
+inline void InterpolateWide(const FTiledRenderingContext& InCtx, const FWidePlaneSteps& Steps, int32_t gx, int32_t gy, FSRPixelShaderWideInput& Wide)
+{
+	const float dx = static_cast<float>(gx - InCtx._X0);
+	const float dy = static_cast<float>(gy - InCtx._Y0);
+
+	const float InvW = InCtx._InvWPlane[0] + dx * InCtx._InvWPlane[1] + dy * InCtx._InvWPlane[2];
+	const VectorRegisterWide RegW = WideDivide(WideSet1(1.f), WideAdd(WideSet1(InvW), WideLoad(Steps._inv_w)));
+
+	Wide._count = InCtx._AttributeCount;
+	for (uint32_t k = 0; k < Wide._count; ++k)
+	{
+		const glm::vec4* Plane = InCtx.AttributePlane(k);
+		const glm::vec4 Value = Plane[0] + dx * Plane[1] + dy * Plane[2];
+		for (int32_t i = 0; i < 4; ++i)
+		{
+			const VectorRegisterWide R = WideAdd(WideSet1(Value[i]), WideLoad(Steps._attributes[k][i]));
+			WideStore(WideMultiply(R, RegW), Wide._attributes[k][i]);
+		}
+	}
+}
+
+inline glm::vec4 GetWideColor(const FSRPixelShaderWideOutput& InOutput, uint32_t k, uint32_t l)
+{
+	return glm::vec4(InOutput._colors[k][0][l], InOutput._colors[k][1][l], InOutput._colors[k][2][l], InOutput._colors[k][3][l]);
+}
+
+// 2x2 quads touched by the pixel masks of two rows, quads start at the even columns
+inline uint32_t CountQuads(uint32_t InRow0, uint32_t InRow1)
+{
+	const uint32_t Rows = InRow0 | InRow1;
+	return CountBits((Rows | (Rows >> 1)) & 0x55555555u);
+}
+
+// 2x2 quads touched by a lane mask of the wide layout, 4 lanes per quad
+inline uint32_t CountLaneQuads(uint32_t InLanes)
+{
+	uint32_t Quads = 0;
+	for (int32_t q = 0; q < SR_WIDE_QUADS; ++q)
+	{
+		Quads += ((InLanes >> (q * 4)) & 0xF) ? 1 : 0;
+	}
+	return Quads;
+}
+
+// rasterize the part of triangle inside rectangle [X0, X1) x [Y0, Y1), return true if HiZ blocks have changed.
+// specialized on the target formats, PIXEL_FORMAT_MAX for any. Stats belongs to the calling thread.
+template <EPixelFormat DepthFormat, EPixelFormat ColorFormat>
+static bool RasterizeTriangleNormal_Tile(const FTiledRenderingContext &InCtx, const int32_t X0, const int32_t Y0, const int32_t X1, const int32_t Y1, FSR_WorkerStats* Stats)
 {
 	const float kOneOverE012 = InCtx._kOneOverE012;
-	const FSR_RasterizedVert& SV0 = InCtx._SV0;
-	const FSR_RasterizedVert& SV1 = InCtx._SV1;
-	const FSR_RasterizedVert& SV2 = InCtx._SV2;
-	const FSRVertexAttributes& VA0 = InCtx._VA0;
-	const FSRVertexAttributes& VA1 = InCtx._VA1;
-	const FSRVertexAttributes& VA2 = InCtx._VA2;
-
-	const int32_t X0 = InCtx._X0;
-	const int32_t Y0 = InCtx._Y0;
-	const int32_t X1 = InCtx._X1;
-	const int32_t Y1 = InCtx._Y1;
-
-	FSR_PixelShader* ps = InCtx._Pointers._ps;
+	const float Z0 = InCtx._Z[0], Z1 = InCtx._Z[1], Z2 = InCtx._Z[2];
+	const FSR_DrawState& State = *InCtx._DrawState;
+
+	FSR_PixelShader* ps = State._Pointers._ps;
 	assert(ps);
 
-	FSRPixelShaderInput PixelInput;
-	FSRPixelShaderOutput PixelOutput;
+	FSRPixelShaderWideInput WideInput;
+	FSRPixelShaderWideOutput WideOutput;
+	FWidePlaneSteps PlaneSteps;
+	SetupWidePlaneSteps(InCtx, PlaneSteps);
 
 	// set count only once
-	PixelInput._attributes._count = VA0._count;
-	PixelOutput._color_cnt = ps->OutputColorCount();
-	assert(PixelOutput._color_cnt <= MAX_MRT_COUNT);
-
-	// depth buffer & color buffer
-	uint8_t* pDepthBufferRow;
-	uint8_t* pColorBufferRows[MAX_MRT_COUNT];
-
-	assert(InCtx._Pointers._rt_depth);
-
-	const glm::vec3 P(X0 + 0.5f, Y0 + 0.5f, 0.f);
-	const float PE12 = EdgeFunction(SV1._screen_pos, SV2._screen_pos, P);
-	const float PE20 = EdgeFunction(SV2._screen_pos, SV0._screen_pos, P);
-	const float PE01 = EdgeFunction(SV0._screen_pos, SV1._screen_pos, P);
-	const glm::vec3 edge12 = SV2._screen_pos - SV1._screen_pos;
-	const glm::vec3 edge20 = SV0._screen_pos - SV2._screen_pos;
-	const glm::vec3 edge01 = SV1._screen_pos - SV0._screen_pos;
-
-	VectorRegister RegEY = MakeVectorRegister(PE12, PE20, PE01, 1.f);
-	VectorRegister RegVX = MakeVectorRegister(edge12.x, edge20.x, edge01.x, 0.f);
-	VectorRegister RegVY = MakeVectorRegister(edge12.y, edge20.y, edge01.y, 0.f);
-	for (int32_t cy = Y0; cy < Y1; ++cy, RegEY = VectorSubtract(RegEY, RegVX))
+	WideOutput._color_cnt = ps->OutputColorCount();
+	assert(WideOutput._color_cnt <= MAX_MRT_COUNT);
+
+	// color buffer rows of the quad
+	uint8_t* pColorBufferRows[2][MAX_MRT_COUNT];
+
+	typedef TSR_PixelAccess<DepthFormat> FDepthAccess;
+	FSR_DepthBuffer* rt_depth = State._Pointers._rt_depth;
+	assert(rt_depth);
+
+	const ECompareFunc DepthFunc = State._depth_func;
+	const bool bDepthWrite = State._bDepthWrite;
+	const bool bDepthOnly = State._bDepthOnly;
+	const uint32_t ColorCount = bDepthOnly ? 0 : WideOutput._color_cnt;
+#if SR_ENABLE_DEBUG_HEATMAPS
+	FSR_DebugHeatmaps* Heatmaps = State._Pointers._heatmaps;
+#endif
+
+	// edges at pixel centers with the top-left bias folded in: e(x, y) = A * x + B * y + C, covered if e >= 0.
+	// C = floor((E(256x + 128, 256y + 128) + bias) / 256) - A * x - B * y, the test is exact.
+	int64_t EdgeC[3];
+	int64_t EdgeMaxOffset[3], EdgeMinOffset[3]; // range of e over a block, from its first pixel
+	for (int32_t e = 0; e < 3; ++e)
 	{
-		pDepthBufferRow = InCtx._Pointers._rt_depth->GetRowData(cy);
-		for (uint32_t k = 0; k < PixelOutput._color_cnt; ++k)
-		{
-			assert(InCtx._Pointers._rt_colors[k]);
-			pColorBufferRows[k] = InCtx._Pointers._rt_colors[k]->GetRowData(cy);;
-		}
+		const int64_t A = InCtx._EdgeA[e];
+		const int64_t B = InCtx._EdgeB[e];
+		EdgeC[e] = (InCtx._EdgeC[e] + (A + B) * (SR_SUBPIXEL_ONE / 2) + InCtx._EdgeBias[e]) >> SR_SUBPIXEL_BITS;
+		EdgeMaxOffset[e] = (SR_RASTER_BLOCK_SIZE - 1) * (std::max<int64_t>(A, 0) + std::max<int64_t>(B, 0));
+		EdgeMinOffset[e] = (SR_RASTER_BLOCK_SIZE - 1) * (std::min<int64_t>(A, 0) + std::min<int64_t>(B, 0));
+	}
 
-		VectorRegister RegEX = RegEY;
-		for (int32_t cx = X0; cx < X1; ++cx, RegEX = VectorAdd(RegEX, RegVY))
+	const VectorRegisterWideInt RegMinusOne = WideIntSet1(-1);
+
+	// depth plane for the HiZ test of blocks: Z(x + i, y + j) = Z(x, y) + i * dZdx + j * dZdy
+	FSR_HiZBuffer* hiz = State._Pointers._hiz;
+	const bool bHiZCull = State._bEnableHiZ;
+	const bool bHiZUpdate = State._bUpdateHiZ;
+	const float dZ0 = Z0 - Z2;
+	const float dZ1 = Z1 - Z2;
+	const float dZdx = SR_SUBPIXEL_ONE * kOneOverE012 * (InCtx._EdgeA[0] * dZ0 + InCtx._EdgeA[1] * dZ1);
+	const float dZdy = SR_SUBPIXEL_ONE * kOneOverE012 * (InCtx._EdgeB[0] * dZ0 + InCtx._EdgeB[1] * dZ1);
+	const float ZMinOffset = (SR_RASTER_BLOCK_SIZE - 1) * (std::min(dZdx, 0.f) + std::min(dZdy, 0.f));
+	const int32_t ZX = X0 & ~(SR_RASTER_BLOCK_SIZE - 1);
+	const int32_t ZY = Y0 & ~(SR_RASTER_BLOCK_SIZE - 1);
+	const int64_t ZPX = (int64_t(ZX) << SR_SUBPIXEL_BITS) + SR_SUBPIXEL_ONE / 2;
+	const int64_t ZPY = (int64_t(ZY) << SR_SUBPIXEL_BITS) + SR_SUBPIXEL_ONE / 2;
+	const float Z00 = Z2 +
+		(static_cast<float>(EvaluateEdge(InCtx, 0, ZPX, ZPY)) * dZ0 + static_cast<float>(EvaluateEdge(InCtx, 1, ZPX, ZPY)) * dZ1) * kOneOverE012;
+	const float TriangleMinZ = InCtx._MinZ;
+	bool bHiZUpdated = false;
+
+	// blocks are aligned to the frame-buffer, not to the tile
+	for (int32_t by = Y0 & ~(SR_RASTER_BLOCK_SIZE - 1); by < Y1; by += SR_RASTER_BLOCK_SIZE)
+	{
+		for (int32_t bx = X0 & ~(SR_RASTER_BLOCK_SIZE - 1); bx < X1; bx += SR_RASTER_BLOCK_SIZE)
 		{
-			float E12 = VectorGetComponent(RegEX, 0);
-			float E20 = VectorGetComponent(RegEX, 1);
-			float E01 = VectorGetComponent(RegEX, 2);
-
-			if (E12 < 0.f)
+			// classify the block against the edges, only the crossing edges are tested per pixel
+			int64_t EBlock[3];
+			uint32_t PartialEdges = 0;
+			bool bReject = false;
+			for (int32_t e = 0; e < 3; ++e)
 			{
-				if (edge12.y <= 0.f)
-				{
-					break; // break out of for cx
-				}
-				// outside of the triangle
-				continue;
+				EBlock[e] = InCtx._EdgeA[e] * bx + InCtx._EdgeB[e] * by + EdgeC[e];
+				bReject |= (EBlock[e] + EdgeMaxOffset[e] < 0);
+				PartialEdges |= (EBlock[e] + EdgeMinOffset[e] < 0) ? (1u << e) : 0u;
 			}
-			if (E20 < 0.f)
+			if (bReject)
 			{
-				if (edge20.y <= 0.f)
-				{
-					break; // break out of for cx
-				}
-				// outside of the triangle
 				continue;
 			}
-			if (E01 < 0.f)
+
+			// nearest depth of the block is behind all pixels of it
+			if (bHiZCull)
 			{
-				if (edge01.y <= 0.f)
+				const float ZBlock = Z00 + (bx - ZX) * dZdx + (by - ZY) * dZdy;
+				const float BlockMinZ = std::max(ZBlock + ZMinOffset, TriangleMinZ);
+				if (BlockMinZ - SR_HIZ_DEPTH_BIAS > hiz->GetBlockMaxDepth(bx, by))
 				{
-					break; // break out of for cx
-				}
-				// outside of the triangle
-				continue;
-			}
-
-			// top-left rule:
-			// the pixel or point is considered to overlap a triangle if it is either inside the triangle or 
-			// lies on either a triangle top edge or any edge that is considered to be a left edge.
-			if (E12 == 0.f) {
-				if (!((edge12.y == 0.f && edge12.x > 0.f) || (edge12.y > 0.f))) {
-					continue;
-				}
-			}
-			if (E20 == 0.f) {
-				if (!((edge20.y == 0.f && edge20.x > 0.f) || (edge20.y > 0.f))) {
-					continue;
-				}
-			}
-			if (E01 == 0.f) {
-				if (!((edge01.y == 0.f && edge01.x > 0.f) || (edge01.y > 0.f))) {
 					continue;
 				}
 			}
 
-			// perspective correct interpolate
-			const float w0 = E12 * kOneOverE012;
-			const float w1 = E20 * kOneOverE012;
-			const float w2 = (1.f - w0 - w1); // fixed for (w0 + w1 + w2) != 1.0
+			// part of block inside [X0, X1) x [Y0, Y1)
+			const int32_t x0 = std::max(bx, X0);
+			const int32_t x1 = std::min(bx + SR_RASTER_BLOCK_SIZE, X1);
+			const int32_t y0 = std::max(by, Y0);
+			const int32_t y1 = std::min(by + SR_RASTER_BLOCK_SIZE, Y1);
+			const uint32_t ColumnMask = ((1u << (x1 - bx)) - 1) & ~((1u << (x0 - bx)) - 1);
 
-			const float depth = w0 * SV0._screen_pos.z + w1 * SV1._screen_pos.z + w2 * SV2._screen_pos.z;
-			const float W = 1.f / (w0 * SV0._inv_w + w1 * SV1._inv_w + w2 * SV2._inv_w);
+			// written pixels of the block & their max depth, for the HiZ
+			uint64_t BlockMask = 0;
+			float BlockMaxZ = -FLT_MAX;
 
-			bool bPassDepth = false;
+			// the block is shaded in 2x2 quads, two rows at a time
+			for (int32_t qy = by; qy < by + SR_RASTER_BLOCK_SIZE; qy += 2)
 			{
-				float PrevDepth;
-				InCtx._Pointers._rt_depth->Read(pDepthBufferRow, cx, PrevDepth);
-				if (depth <= PrevDepth)
+				// depth-passed pixels of the two rows
+				uint32_t PassMasks[2] = { 0, 0 };
+#if SR_ENABLE_PERFORMACE_STAT
+				uint32_t CoverMasks[2] = { 0, 0 };
+#endif
+				for (int32_t r = 0; r < 2; ++r)
 				{
-					InCtx._Pointers._rt_depth->Write(pDepthBufferRow, cx, depth);
-					bPassDepth = true;
-				}
-			}
-
-			if (!bPassDepth)
-			{
-				continue;
-			}
-
-			// attributes
-			InterpolateVertexAttributes(VA0, w0, VA1, w1, VA2, w2, W, PixelInput._attributes);
-
-			ps->Process(InCtx._psCtx, PixelInput, PixelOutput);
-
-			// output and merge color
-			for (uint32_t k = 0; k < PixelOutput._color_cnt; ++k)
-			{
-				const glm::vec4& color = PixelOutput._colors[k];
-				FSR_Texture2D* rt = InCtx._Pointers._rt_colors[k];
-				rt->Write(pColorBufferRows[k], cx, &color.r);
-			} // end for k
-
-		} //end cx
-	} // end cy
-}
-
-static void MultiThreadsProcessTile(const FTiledRenderingContext& InCtx, void (*handler)(const FTiledRenderingContext& InCtx));
-static void RasterizeTriangleNormal(const FSR_Context& InContext, const FSRVertexShaderOutput& A, const FSRVertexShaderOutput& B, const FSRVertexShaderOutput& C)
-{
-	const FSRVertexShaderOutput* ABC[3] = { &A, &B, &C };
-	FSR_RasterizedVert screen[3];
-
-	// perspective divide
-	for (int32_t k=0; k<3; ++k)
-	{
-		const glm::vec4& vertex = ABC[k]->_vertex;
-		FSR_RasterizedVert& srv = screen[k];
+					const int32_t cy = qy + r;
+					if (cy < y0 || cy >= y1)
+					{
+						continue;
+					}
 
-		float inv_w = 1.f / vertex.w;
-		srv._inv_w = inv_w;
-#if 0
-		srv._ndc_pos.x = vertex.x * inv_w;
-		srv._ndc_pos.y = vertex.y * inv_w;
-		srv._ndc_pos.z = vertex.z * inv_w;
-#else
-		VectorRegister R0 = VectorLoadFloat3_W0(&vertex.x);
-		VectorRegister R1 = VectorSetFloat1(inv_w);
-		VectorRegister R2 = VectorMultiply(R0, R1);
-		VectorStoreFloat3(R2, &(srv._ndc_pos.x));
+					// coverage mask of the row, a crossing edge is within its block range and fits in 32 bits
+					uint32_t RowMask = ColumnMask;
+					for (uint32_t Edges = PartialEdges; Edges; Edges &= Edges - 1)
+					{
+						const uint32_t e = CountTrailingZeros(Edges);
+						const int32_t dEdx = static_cast<int32_t>(InCtx._EdgeA[e]);
+						const int32_t ERow = static_cast<int32_t>(EBlock[e] + (cy - by) * InCtx._EdgeB[e]);
+
+						VectorRegisterWideInt RegE = WideIntAdd(WideIntSet1(ERow), WideIntRamp(dEdx));
+						const VectorRegisterWideInt RegDx = WideIntSet1(dEdx * SR_SIMD_WIDTH);
+						uint32_t EdgeMask = 0;
+						for (int32_t l = 0; l < SR_RASTER_BLOCK_SIZE; l += SR_SIMD_WIDTH)
+						{
+							EdgeMask |= WideIntMoveMask(WideIntCompareGT(RegE, RegMinusOne)) << l;
+							RegE = WideIntAdd(RegE, RegDx);
+						}
+						RowMask &= EdgeMask;
+					}
+					if (!RowMask)
+					{
+						continue;
+					}
+					BlockMask |= uint64_t(RowMask) << ((cy - by) * SR_RASTER_BLOCK_SIZE);
+#if SR_ENABLE_PERFORMACE_STAT
+					CoverMasks[r] = RowMask;
 #endif
-		srv._screen_pos = InContext.NDCToScreenPostion(srv._ndc_pos);
-	}
 
-	uint32_t iv0 = 0, iv1 = 1, iv2 = 2;
-	float E012 = EdgeFunction(screen[0]._screen_pos, screen[1]._screen_pos, screen[2]._screen_pos);
-	if (E012 > -1.f && E012 < 1.f)
-	{
-		return; // DISCARD!
-	}
-
-	bool bClockwise = (E012 >= 0.f);
-	bool bClipped = bClockwise ^ (InContext._front_face == EFrontFace::FACE_CW);
-	if (bClipped)
-	{
-		return;  // DISCARD!
-	}
-
-	if (!bClockwise) // exchange v to clockwise
-	{
-		iv1 = 2; iv2 = 1;
-		E012 = -E012;
-	}
-
-	FSR_Rectangle bbox;
-	const FSR_Rectangle bbox_triangle = BoundingboxOfTriangle(screen[0]._screen_pos, screen[1]._screen_pos, screen[2]._screen_pos);
-	if (!intersect(bbox_triangle, InContext.ViewportRectangle(), bbox))
-	{
-		return; // DISCARD!
-	}
+					uint8_t* pDepthBufferRow = rt_depth->GetRowData(cy);
+					const int64_t PY = (int64_t(cy) << SR_SUBPIXEL_BITS) + SR_SUBPIXEL_ONE / 2;
+					for (; RowMask; RowMask &= RowMask - 1)
+					{
+						const uint32_t l = CountTrailingZeros(RowMask);
+						const int32_t cx = bx + l;
+						const int64_t PX = (int64_t(cx) << SR_SUBPIXEL_BITS) + SR_SUBPIXEL_ONE / 2;
+
+						const float w0 = static_cast<float>(EvaluateEdge(InCtx, 0, PX, PY)) * kOneOverE012;
+						const float w1 = static_cast<float>(EvaluateEdge(InCtx, 1, PX, PY)) * kOneOverE012;
+						const float w2 = (1.f - w0 - w1); // fixed for (w0 + w1 + w2) != 1.0
+
+						const float depth = w0 * Z0 + w1 * Z1 + w2 * Z2;
+
+						float PrevDepth = FDepthAccess::ReadDepth(rt_depth, pDepthBufferRow, cx);
+						if (DepthCompare(DepthFunc, depth, PrevDepth))
+						{
+							if (bDepthWrite)
+							{
+								FDepthAccess::WriteDepth(rt_depth, pDepthBufferRow, cx, depth);
+								PrevDepth = depth;
+							}
+							PassMasks[r] |= (1u << l);
+						}
+						BlockMaxZ = std::max(BlockMaxZ, PrevDepth);
+#if SR_ENABLE_DEBUG_HEATMAPS
+						Heatmaps->AddDepthTest(cx, cy, (PassMasks[r] >> l) & 1);
+#endif
+					} // end for l
+				} // end for r
 
-	FTiledRenderingContext TileCtx;
+#if SR_ENABLE_PERFORMACE_STAT
+				Stats->_pixels_tested += CountBits(CoverMasks[0]) + CountBits(CoverMasks[1]);
+				Stats->_pixels_passed += CountBits(PassMasks[0]) + CountBits(PassMasks[1]);
+				Stats->_quads_culled += CountQuads(CoverMasks[0], CoverMasks[1]) - CountQuads(PassMasks[0], PassMasks[1]);
+#endif
 
-	TileCtx._SRCtx = &InContext;
-	TileCtx._Pointers = InContext._pointers_shadow;
-	TileCtx._psCtx._mvps = InContext._mvps;
-	TileCtx._psCtx._material = InContext._pointers_shadow._material;
+				// early-z: depth-only pass ends here
+				const uint32_t PassMask = PassMasks[0] | PassMasks[1];
+				if (!PassMask || bDepthOnly)
+				{
+					continue;
+				}
 
-	const float kOneOverE012 = 1.f / E012;
-	const FSR_RasterizedVert& SV0 = screen[iv0];
-	const FSR_RasterizedVert& SV1 = screen[iv1];
-	const FSR_RasterizedVert& SV2 = screen[iv2];
+				for (int32_t r = 0; r < 2; ++r)
+				{
+					for (uint32_t k = 0; k < ColorCount && PassMasks[r]; ++k)
+					{
+						assert(State._Pointers._rt_colors[k]);
+						pColorBufferRows[r][k] = State._Pointers._rt_colors[k]->GetRowData(qy + r);
+					}
+				}
 
-	TileCtx._kOneOverE012 = kOneOverE012;
-	TileCtx._SV0 = SV0;
-	TileCtx._SV1 = SV1;
-	TileCtx._SV2 = SV2;
+				// SR_WIDE_QUADS quads a time, quads start at the even columns
+				for (int32_t gl = 0; gl < SR_RASTER_BLOCK_SIZE; gl += SR_WIDE_QUADS * 2)
+				{
+					WideInput._mask = 0;
+					for (int32_t q = 0; q < SR_WIDE_QUADS; ++q)
+					{
+						const uint32_t l = gl + q * 2;
+						const uint32_t QuadMask = ((PassMasks[0] >> l) & 0x3) | (((PassMasks[1] >> l) & 0x3) << 2);
+						WideInput._mask |= QuadMask << (q * 4);
+					}
+					if (!WideInput._mask)
+					{
+						continue;
+					}
 
-	DivideVertexAttributesByW(ABC[iv0]->_attributes, SV0._inv_w, TileCtx._VA0);
-	DivideVertexAttributesByW(ABC[iv1]->_attributes, SV1._inv_w, TileCtx._VA1);
-	DivideVertexAttributesByW(ABC[iv2]->_attributes, SV2._inv_w, TileCtx._VA2);
+					InterpolateWide(InCtx, PlaneSteps, bx + gl, qy, WideInput);
 
-	const int32_t X0 = static_cast<int32_t>(floor(bbox._minx));
-	const int32_t Y0 = static_cast<int32_t>(floor(bbox._miny));
-	const int32_t X1 = static_cast<int32_t>(ceilf(bbox._maxx));
-	const int32_t Y1 = static_cast<int32_t>(ceilf(bbox._maxy));
+					ps->ProcessWide(State._psCtx, WideInput, WideOutput);
+#if SR_ENABLE_PERFORMACE_STAT
+					Stats->_ps_invoke_count++;
+					Stats->_pixels_shaded += CountBits(WideInput._mask);
+					Stats->_color_write_count += CountBits(WideInput._mask) * ColorCount;
+#endif
 
-	TileCtx._X0 = X0;
-	TileCtx._Y0 = Y0;
-	TileCtx._X1 = X1;
-	TileCtx._Y1 = Y1;
+					// output and merge color
+					for (uint32_t Lanes = WideInput._mask; Lanes; Lanes &= Lanes - 1)
+					{
+						const uint32_t i = CountTrailingZeros(Lanes);
+						const int32_t cx = bx + gl + ((i >> 2) << 1) + (i & 1);
+						const uint32_t r = (i >> 1) & 1;
+#if SR_ENABLE_DEBUG_HEATMAPS
+						Heatmaps->AddShaded(cx, qy + r);
+#endif
+						for (uint32_t k = 0; k < ColorCount; ++k)
+						{
+							WriteColor<ColorFormat>(State._Pointers._rt_colors[k], pColorBufferRows[r][k], cx, GetWideColor(WideOutput, k, i), State._color_write_mask);
+						} // end for k
+					} // end for Lanes
+				} // end for gl
+			} // end qy
+
+			if (bHiZUpdate && BlockMask)
+			{
+				bHiZUpdated |= hiz->AccumulateBlock(bx, by, BlockMask, BlockMaxZ);
+			}
+		} // end bx
+	} // end by
 
-	if (InContext._bEnableMultiThreads) {
-		MultiThreadsProcessTile(TileCtx, &RasterizeTriangleNormal_Tile);
-	}
-	else {
-		RasterizeTriangleNormal_Tile(TileCtx);
-	}
+	return bHiZUpdated;
 }
 
-static void RasterizeTriangleMSAA4_Tile(const FTiledRenderingContext& InCtx)
+template <EPixelFormat DepthFormat, EPixelFormat ColorFormat>
+static void RasterizeTriangleMSAA4_Tile(const FTiledRenderingContext& InCtx, const int32_t X0, const int32_t Y0, const int32_t X1, const int32_t Y1, FSR_WorkerStats* Stats)
 {
-	static const float samples_pattern[4][2] = { { 0.25f, 0.25f }, { 0.75f, 0.25f }, { 0.75f, 0.75f }, { 0.25f, 0.75f } };
+	// sample positions in sub-pixel units
+	static const int32_t samples_pattern[4][2] = {
+		{ SR_SUBPIXEL_ONE / 4, SR_SUBPIXEL_ONE / 4 }, { SR_SUBPIXEL_ONE * 3 / 4, SR_SUBPIXEL_ONE / 4 },
+		{ SR_SUBPIXEL_ONE * 3 / 4, SR_SUBPIXEL_ONE * 3 / 4 }, { SR_SUBPIXEL_ONE / 4, SR_SUBPIXEL_ONE * 3 / 4 } };
 
 	const float kOneOverE012 = InCtx._kOneOverE012;
-	const FSR_RasterizedVert& SV0 = InCtx._SV0;
-	const FSR_RasterizedVert& SV1 = InCtx._SV1;
-	const FSR_RasterizedVert& SV2 = InCtx._SV2;
-	const FSRVertexAttributes& VA0 = InCtx._VA0;
-	const FSRVertexAttributes& VA1 = InCtx._VA1;
-	const FSRVertexAttributes& VA2 = InCtx._VA2;
-
-	const int32_t X0 = InCtx._X0;
-	const int32_t Y0 = InCtx._Y0;
-	const int32_t X1 = InCtx._X1;
-	const int32_t Y1 = InCtx._Y1;
-
-	FSR_PixelShader* ps = InCtx._Pointers._ps;
+	const float Z0 = InCtx._Z[0], Z1 = InCtx._Z[1], Z2 = InCtx._Z[2];
+	const FSR_DrawState& State = *InCtx._DrawState;
+
+	FSR_PixelShader* ps = State._Pointers._ps;
 	assert(ps);
 
-	glm::vec3 P(0);
-	FSRPixelShaderInput PixelInput;
-	FSRPixelShaderOutput PixelOutput;
+	FSRPixelShaderWideInput WideInput;
+	FSRPixelShaderWideOutput WideOutput;
+	FWidePlaneSteps PlaneSteps;
+	SetupWidePlaneSteps(InCtx, PlaneSteps);
 
 	// set count only once
-	PixelInput._attributes._count = VA0._count;
-	PixelOutput._color_cnt = ps->OutputColorCount();
+	WideOutput._color_cnt = ps->OutputColorCount();
+
+	// samples of a pixel are adjacent in the MSAA targets
+	typedef TSR_PixelAccess<DepthFormat> FDepthAccess;
+	FSR_DepthBuffer* rt_depth = State._Pointers._rt_depth_msaa;
+	assert(rt_depth);
+	const ECompareFunc DepthFunc = State._depth_func;
+	const bool bDepthWrite = State._bDepthWrite;
+	const uint32_t ColorCount = State._bDepthOnly ? 0 : WideOutput._color_cnt;
+#if SR_ENABLE_DEBUG_HEATMAPS
+	FSR_DebugHeatmaps* Heatmaps = State._Pointers._heatmaps;
+#endif
 
-	for (int32_t cy = Y0; cy < Y1; ++cy)
+	// SR_WIDE_QUADS 2x2 quads a time, aligned to the frame-buffer
+	for (int32_t qy = Y0 & ~1; qy < Y1; qy += 2)
 	{
-		for (int32_t cx = X0; cx < X1; ++cx)
+		for (int32_t gx = X0 & ~1; gx < X1; gx += SR_WIDE_QUADS * 2)
 		{
-			int32_t bitMask = 0;
-			for (int32_t sampleIndex = 0; sampleIndex < 4; ++sampleIndex)
+			// covered & depth-passed samples of the pixels
+			int32_t bitMasks[SR_SIMD_WIDTH] = { 0 };
+#if SR_ENABLE_PERFORMACE_STAT
+			uint32_t CoverLanes = 0;
+#endif
+			for (int32_t i = 0; i < SR_SIMD_WIDTH; ++i)
 			{
-
-				P.x = cx + samples_pattern[sampleIndex][0];
-				P.y = cy + samples_pattern[sampleIndex][1];
-
-				float E12 = EdgeFunction(SV1._screen_pos, SV2._screen_pos, P);
-				float E20 = EdgeFunction(SV2._screen_pos, SV0._screen_pos, P);
-				float E01 = EdgeFunction(SV0._screen_pos, SV1._screen_pos, P);
-				if (E12 < 0.f || E20 < 0.f || E01 < 0.f)
+				const int32_t cx = gx + ((i >> 2) << 1) + (i & 1);
+				const int32_t cy = qy + ((i >> 1) & 1);
+				if (cx < X0 || cx >= X1 || cy < Y0 || cy >= Y1)
 				{
-					// outside of the triangle
 					continue;
 				}
 
-				glm::vec3 edge12 = SV2._screen_pos - SV1._screen_pos;
-				glm::vec3 edge20 = SV0._screen_pos - SV2._screen_pos;
-				glm::vec3 edge01 = SV1._screen_pos - SV0._screen_pos;
+				uint8_t* pDepthBufferRow = rt_depth->GetRowData(cy);
+				const uint32_t cx_msaa = cx * MSAA_SAMPLES;
+				for (int32_t sampleIndex = 0; sampleIndex < 4; ++sampleIndex)
+				{
+					const int64_t PX = (int64_t(cx) << SR_SUBPIXEL_BITS) + samples_pattern[sampleIndex][0];
+					const int64_t PY = (int64_t(cy) << SR_SUBPIXEL_BITS) + samples_pattern[sampleIndex][1];
+
+					const int64_t E12 = EvaluateEdge(InCtx, 0, PX, PY);
+					const int64_t E20 = EvaluateEdge(InCtx, 1, PX, PY);
+					const int64_t E01 = EvaluateEdge(InCtx, 2, PX, PY);
 
-				// top-left rule:
-				// the pixel or point is considered to overlap a triangle if it is either inside the triangle or 
-				// lies on either a triangle top edge or any edge that is considered to be a left edge.
-				if (E12 == 0.f) {
-					if (!((edge12.y == 0.f && edge12.x > 0.f) || (edge12.y > 0.f))) {
+					// top-left rule: samples on an edge only belong to its triangle if the edge is a top or left edge.
+					if (E12 + InCtx._EdgeBias[0] < 0 || E20 + InCtx._EdgeBias[1] < 0 || E01 + InCtx._EdgeBias[2] < 0)
+					{
+						// outside of the triangle
 						continue;
 					}
-				}
-				if (E20 == 0.f) {
-					if (!((edge20.y == 0.f && edge20.x > 0.f) || (edge20.y > 0.f))) {
-						continue;
+#if SR_ENABLE_PERFORMACE_STAT
+					Stats->_pixels_tested++;
+					CoverLanes |= (1u << i);
+#endif
+
+					// perspective correct interpolate
+					const float w0 = static_cast<float>(E12) * kOneOverE012;
+					const float w1 = static_cast<float>(E20) * kOneOverE012;
+					const float w2 = (1.f - w0 - w1); // fixed for (w0 + w1 + w2) != 1.0
+
+					const float depth = w0 * Z0 + w1 * Z1 + w2 * Z2;
+
+					bool bPassDepth = false;
+					{
+						const float PrevDepth = FDepthAccess::ReadDepth(rt_depth, pDepthBufferRow, cx_msaa + sampleIndex);
+						bPassDepth = DepthCompare(DepthFunc, depth, PrevDepth);
+						if (bPassDepth && bDepthWrite)
+						{
+							FDepthAccess::WriteDepth(rt_depth, pDepthBufferRow, cx_msaa + sampleIndex, depth);
+						}
 					}
-				}
-				if (E01 == 0.f) {
-					if (!((edge01.y == 0.f && edge01.x > 0.f) || (edge01.y > 0.f))) {
+#if SR_ENABLE_DEBUG_HEATMAPS
+					Heatmaps->AddDepthTest(cx, cy, bPassDepth);
+#endif
+
+					if (!bPassDepth)
+					{
 						continue;
 					}
-				}
-
-				// perspective correct interpolate
-				const float w0 = E12 * kOneOverE012;
-				const float w1 = E20 * kOneOverE012;
-				const float w2 = (1.f - w0 - w1); // fixed for (w0 + w1 + w2) != 1.0
-
-				const float depth = w0 * SV0._screen_pos.z + w1 * SV1._screen_pos.z + w2 * SV2._screen_pos.z;
 
-				bool bPassDepth = InCtx._SRCtx->DepthTestAndOverrideMSAA(cx, cy, depth, sampleIndex);
-
-				if (!bPassDepth)
-				{
-					continue;
-				}
+					bitMasks[i] |= (0x01 << sampleIndex);
+				} // end for sampleIndex
+			} // end for i
 
-				bitMask |= (0x01 << sampleIndex);
-			} // end for sampleIndex
+			WideInput._mask = 0;
+			for (int32_t i = 0; i < SR_SIMD_WIDTH; ++i)
+			{
+				WideInput._mask |= bitMasks[i] ? (1 << i) : 0;
+#if SR_ENABLE_PERFORMACE_STAT
+				Stats->_pixels_passed += CountBits(bitMasks[i]);
+#endif
+			}
+#if SR_ENABLE_PERFORMACE_STAT
+			Stats->_quads_culled += CountLaneQuads(CoverLanes) - CountLaneQuads(WideInput._mask);
+#endif
 
-			if (!bitMask)
+			// early-z: depth-only pass ends here
+			if (!WideInput._mask || !ColorCount)
 			{
 				continue;
 			}
 
-			// calculate center of pixel
+			// shaded once per pixel, at its center
+			InterpolateWide(InCtx, PlaneSteps, gx, qy, WideInput);
+			ps->ProcessWide(State._psCtx, WideInput, WideOutput);
+#if SR_ENABLE_PERFORMACE_STAT
+			Stats->_ps_invoke_count++;
+			Stats->_pixels_shaded += CountBits(WideInput._mask);
+#endif
+#if SR_ENABLE_DEBUG_HEATMAPS
+			for (uint32_t Lanes = WideInput._mask; Lanes; Lanes &= Lanes - 1)
 			{
-				P.x = cx + 0.5f;
-				P.y = cy + 0.5f;
-
-				float E12 = EdgeFunction(SV1._screen_pos, SV2._screen_pos, P);
-				float E20 = EdgeFunction(SV2._screen_pos, SV0._screen_pos, P);
-				float E01 = EdgeFunction(SV0._screen_pos, SV1._screen_pos, P);
-				// perspective correct interpolate
-				const float w0 = E12 * kOneOverE012;
-				const float w1 = E20 * kOneOverE012;
-				const float w2 = (1.f - w0 - w1); // fixed for (w0 + w1 + w2) != 1.0
-				const float W = 1.f / (w0 * SV0._inv_w + w1 * SV1._inv_w + w2 * SV2._inv_w);
-
-				// attributes
-				InterpolateVertexAttributes(VA0, w0, VA1, w1, VA2, w2, W, PixelInput._attributes);
+				const uint32_t i = CountTrailingZeros(Lanes);
+				Heatmaps->AddShaded(gx + ((i >> 2) << 1) + (i & 1), qy + ((i >> 1) & 1));
 			}
+#endif
 
-			ps->Process(InCtx._psCtx, PixelInput, PixelOutput);
+			// output and merge color
+			for (uint32_t k = 0; k < ColorCount; ++k)
+			{
+				FSR_Texture2D* rt = State._Pointers._rt_colors_msaa[k];
+				assert(rt);
+				for (uint32_t Lanes = WideInput._mask; Lanes; Lanes &= Lanes - 1)
+				{
+					const uint32_t i = CountTrailingZeros(Lanes);
+					const glm::vec4 Color = GetWideColor(WideOutput, k, i);
+
+					uint8_t* pColorBufferRow = rt->GetRowData(qy + ((i >> 1) & 1));
+					const uint32_t cx_msaa = (gx + ((i >> 2) << 1) + (i & 1)) * MSAA_SAMPLES;
+					for (int32_t sampleIndex = 0; sampleIndex < MSAA_SAMPLES; ++sampleIndex)
+					{
+						if (bitMasks[i] & (0x01 << sampleIndex))
+						{
+#if SR_ENABLE_PERFORMACE_STAT
+							Stats->_color_write_count++;
+#endif
+							WriteColor<ColorFormat>(rt, pColorBufferRow, cx_msaa + sampleIndex, Color, State._color_write_mask);
+						}
+					}
+				} // end for Lanes
+			} // end for k
+		} // end gx
+	} // end qy
+}
 
-			InCtx._SRCtx->OutputAndMergeColorMSAA(cx, cy, PixelOutput, bitMask);
+// per-thread state of the geometry front-end
+struct FGeometryContext
+{
+	const FSR_Context*		_SRCtx;
+	const FSR_DrawState*	_DrawState;
+	FSR_Performance*		_stats;
 
-		} //end cx
-	} // end cy
-}
+	// set-up triangles go to the bins directly, or to the staging list of a chunk
+	FSR_TileBins*	_bins;
+	uint32_t		_chunk; // SR_INVALID_INDEX: bin directly
+
+	// clip vertex buffer
+	FSRVertexShaderOutput	_clip_vtx_buffer0[MAX_CLIP_VTXCOUNT];
+	FSRVertexShaderOutput	_clip_vtx_buffer1[MAX_CLIP_VTXCOUNT];
 
-static void RasterizeTriangleMSAA4(const FSR_Context& InContext, const FSRVertexShaderOutput& A, const FSRVertexShaderOutput& B, const FSRVertexShaderOutput& C)
+	inline void Emit(const FTiledRenderingContext& InTriangle)
+	{
+		if (_chunk == uint32_t(SR_INVALID_INDEX)) {
+			_bins->AddTriangle(InTriangle);
+		}
+		else {
+			_bins->StageChunkTriangle(_chunk, InTriangle);
+		}
+	}
+};
+
+// triangle setup, shared by all sample patterns: the vertices are snapped to the sub-pixel grid and
+// the edge equations are set up in 64-bit integers, so coverage does not depend on float rounding.
+static void RasterizeTriangle(FGeometryContext& Geo, const FSRVertexShaderOutput& A, const FSRVertexShaderOutput& B, const FSRVertexShaderOutput& C)
 {
-	assert(InContext._MSAASamplesNum == 4);
+	const FSR_Context& InContext = *Geo._SRCtx;
+	assert(!InContext._bEnableMSAA || InContext._MSAASamplesNum == 4);
 
 	const FSRVertexShaderOutput* ABC[3] = { &A, &B, &C };
 	FSR_RasterizedVert screen[3];
+	int64_t FX[3], FY[3];
 
 	// perspective divide
-	for (uint32_t i = 0; i < 3; ++i)
+	for (int32_t k=0; k<3; ++k)
 	{
-		float inv_w = 1.f / ABC[i]->_vertex.w;
-		screen[i]._inv_w = inv_w;
-		screen[i]._ndc_pos.x = ABC[i]->_vertex.x * inv_w;
-		screen[i]._ndc_pos.y = ABC[i]->_vertex.y * inv_w;
-		screen[i]._ndc_pos.z = ABC[i]->_vertex.z * inv_w;
-		screen[i]._screen_pos = InContext.NDCToScreenPostion(screen[i]._ndc_pos);
+		const glm::vec4& vertex = ABC[k]->_vertex;
+		FSR_RasterizedVert& srv = screen[k];
+
+		float inv_w = 1.f / vertex.w;
+		srv._inv_w = inv_w;
+#if 0
+		srv._ndc_pos.x = vertex.x * inv_w;
+		srv._ndc_pos.y = vertex.y * inv_w;
+		srv._ndc_pos.z = vertex.z * inv_w;
+#else
+		VectorRegister R0 = VectorLoadFloat3_W0(&vertex.x);
+		VectorRegister R1 = VectorSetFloat1(inv_w);
+		VectorRegister R2 = VectorMultiply(R0, R1);
+		VectorStoreFloat3(R2, &(srv._ndc_pos.x));
+#endif
+		srv._screen_pos = InContext.NDCToScreenPostion(srv._ndc_pos);
+
+		// snap to 16.8 fixed point
+		FX[k] = lrintf(srv._screen_pos.x * SR_SUBPIXEL_ONE);
+		FY[k] = lrintf(srv._screen_pos.y * SR_SUBPIXEL_ONE);
 	}
 
 	uint32_t iv0 = 0, iv1 = 1, iv2 = 2;
-	float E012 = EdgeFunction(screen[0]._screen_pos, screen[1]._screen_pos, screen[2]._screen_pos);
-	if (E012 > -1.f && E012 < 1.f)
+	int64_t E012 = (FX[2] - FX[0]) * (FY[1] - FY[0]) - (FY[2] - FY[0]) * (FX[1] - FX[0]);
+	if (E012 == 0)
 	{
-		return; // DISCARD!
+		return; // DISCARD! no sample can be covered
 	}
 
-	bool bClockwise = (E012 >= 0.f);
+	bool bClockwise = (E012 > 0);
 	bool bClipped = bClockwise ^ (InContext._front_face == EFrontFace::FACE_CW);
 	if (bClipped)
 	{
@@ -763,26 +934,40 @@ static void RasterizeTriangleMSAA4(const FSR_Context& InContext, const FSRVertex
 		return; // DISCARD!
 	}
 
-	FTiledRenderingContext TileCtx;
+	FTiledRenderingContextStorage Storage;
+	FTiledRenderingContext& TileCtx = Storage._setup;
 
-	TileCtx._SRCtx = &InContext;
-	TileCtx._Pointers = InContext._pointers_shadow;
-	TileCtx._psCtx._mvps = InContext._mvps;
-	TileCtx._psCtx._material = InContext._pointers_shadow._material;
+	TileCtx._DrawState = Geo._DrawState;
 
-	const float kOneOverE012 = 1.f / E012;
-	const FSR_RasterizedVert& SV0 = screen[iv0];
-	const FSR_RasterizedVert& SV1 = screen[iv1];
-	const FSR_RasterizedVert& SV2 = screen[iv2];
+	const float kOneOverE012 = 1.f / static_cast<float>(E012);
+	const uint32_t iv[3] = { iv0, iv1, iv2 };
 
 	TileCtx._kOneOverE012 = kOneOverE012;
-	TileCtx._SV0 = SV0;
-	TileCtx._SV1 = SV1;
-	TileCtx._SV2 = SV2;
+	for (int32_t k = 0; k < 3; ++k)
+	{
+		TileCtx._Z[k] = screen[iv[k]]._screen_pos.z;
+	}
+	TileCtx._MinZ = std::min(TileCtx._Z[0], std::min(TileCtx._Z[1], TileCtx._Z[2]));
 
-	DivideVertexAttributesByW(ABC[iv0]->_attributes, SV0._inv_w, TileCtx._VA0);
-	DivideVertexAttributesByW(ABC[iv1]->_attributes, SV1._inv_w, TileCtx._VA1);
-	DivideVertexAttributesByW(ABC[iv2]->_attributes, SV2._inv_w, TileCtx._VA2);
+	// edges 12, 20, 01: E(P) = (P.x - Va.x) * (Vb.y - Va.y) - (P.y - Va.y) * (Vb.x - Va.x)
+	const uint32_t EdgeVa[3] = { iv1, iv2, iv0 };
+	const uint32_t EdgeVb[3] = { iv2, iv0, iv1 };
+	for (int32_t e = 0; e < 3; ++e)
+	{
+		const uint32_t a = EdgeVa[e], b = EdgeVb[e];
+		const int64_t EA = FY[b] - FY[a];
+		const int64_t EB = FX[a] - FX[b];
+
+		TileCtx._EdgeA[e] = EA;
+		TileCtx._EdgeB[e] = EB;
+		TileCtx._EdgeC[e] = -(EA * FX[a] + EB * FY[a]);
+
+		// top-left rule:
+		// the pixel or point is considered to overlap a triangle if it is either inside the triangle or 
+		// lies on either a triangle top edge or any edge that is considered to be a left edge.
+		const bool bTopLeft = (EA > 0) || (EA == 0 && EB < 0);
+		TileCtx._EdgeBias[e] = bTopLeft ? 0 : -1;
+	}
 
 	const int32_t X0 = static_cast<int32_t>(floor(bbox._minx));
 	const int32_t Y0 = static_cast<int32_t>(floor(bbox._miny));
@@ -794,24 +979,54 @@ static void RasterizeTriangleMSAA4(const FSR_Context& InContext, const FSRVertex
 	TileCtx._X1 = X1;
 	TileCtx._Y1 = Y1;
 
-	if (InContext._bEnableMultiThreads) {
-		MultiThreadsProcessTile(TileCtx, &RasterizeTriangleMSAA4_Tile);
-	}
-	else {
-		RasterizeTriangleMSAA4_Tile(TileCtx);
+	// planes of the perspective-correct values: v(x, y) = w0 * v0 + w1 * v1 + w2 * v2 with w2 = 1 - w0 - w1,
+	// = v2 + w0 * (v0 - v2) + w1 * (v1 - v2), at the pixel center (X0, Y0) & per pixel step.
+	const int64_t OPX = (int64_t(X0) << SR_SUBPIXEL_BITS) + SR_SUBPIXEL_ONE / 2;
+	const int64_t OPY = (int64_t(Y0) << SR_SUBPIXEL_BITS) + SR_SUBPIXEL_ONE / 2;
+	const float Bary[3][2] = {
+		{ static_cast<float>(EvaluateEdge(TileCtx, 0, OPX, OPY)) * kOneOverE012, static_cast<float>(EvaluateEdge(TileCtx, 1, OPX, OPY)) * kOneOverE012 },
+		{ static_cast<float>(TileCtx._EdgeA[0] * SR_SUBPIXEL_ONE) * kOneOverE012, static_cast<float>(TileCtx._EdgeA[1] * SR_SUBPIXEL_ONE) * kOneOverE012 },
+		{ static_cast<float>(TileCtx._EdgeB[0] * SR_SUBPIXEL_ONE) * kOneOverE012, static_cast<float>(TileCtx._EdgeB[1] * SR_SUBPIXEL_ONE) * kOneOverE012 } };
+
+	const float InvW[3] = { screen[iv0]._inv_w, screen[iv1]._inv_w, screen[iv2]._inv_w };
+	for (int32_t p = 0; p < 3; ++p)
+	{
+		TileCtx._InvWPlane[p] = Bary[p][0] * (InvW[0] - InvW[2]) + Bary[p][1] * (InvW[1] - InvW[2]);
 	}
-}
+	TileCtx._InvWPlane[0] += InvW[2];
 
-static void RasterizeTriangle(const FSR_Context& InContext, const FSRVertexShaderOutput& A, const FSRVertexShaderOutput& B, const FSRVertexShaderOutput& C)
-{
-	if (InContext._bEnableMSAA)
+	// depth-only draws skip the attributes
+	TileCtx._AttributeCount = Geo._DrawState->_bDepthOnly ? 0 : A._attributes._count;
+	if (TileCtx._AttributeCount)
 	{
-		RasterizeTriangleMSAA4(InContext, A, B, C);
+		glm::vec4 VA[3][MAX_ATTRIBUTES_COUNT];
+		for (int32_t k = 0; k < 3; ++k)
+		{
+			DivideVertexAttributesByW(ABC[iv[k]]->_attributes, InvW[k], VA[k]);
+		}
+		for (uint32_t k = 0; k < TileCtx._AttributeCount; ++k)
+		{
+			const glm::vec4 d0 = VA[0][k] - VA[2][k];
+			const glm::vec4 d1 = VA[1][k] - VA[2][k];
+			glm::vec4* Plane = TileCtx.AttributePlane(k);
+			for (int32_t p = 0; p < 3; ++p)
+			{
+				Plane[p] = Bary[p][0] * d0 + Bary[p][1] * d1;
+			}
+			Plane[0] += VA[2][k];
+		}
 	}
-	else
+
+	// occluded by the depth of earlier flushes
+	if (Geo._DrawState->_bBinCullHiZ)
 	{
-		RasterizeTriangleNormal(InContext, A, B, C);
+		if (TileCtx._MinZ - SR_HIZ_DEPTH_BIAS > Geo._DrawState->_Pointers._hiz->GetMaxDepth(X0, Y0, X1, Y1))
+		{
+			return; // DISCARD!
+		}
 	}
+
+	Geo.Emit(TileCtx);
 }
 //////////////////////////////////////////////////////////////////////////
 
@@ -846,34 +1061,28 @@ inline bool IsOnNegtiveSideOf_BotPlane(const glm::vec4& V0, const glm::vec4& V1,
 }
 
 // draw a triangle
-void FSR_Renderer::DrawTriangle(const FSR_Context& InContext, const FSRVertex& InA, const FSRVertex& InB, const FSRVertex& InC)
+inline bool IsInsideOfVolume(const glm::vec4& V)
 {
-	FSR_Context& InCtx = const_cast<FSR_Context&>(InContext);
+	for (uint32_t i = 0; i < SR_ARRAY_COUNT(kClipPlanes); ++i)
+	{
+		if (VDOTP(V, kClipPlanes[i]) < 0.f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
+// culling, clipping & setup of a vertex-shaded triangle
+static void ProcessShadedTriangle(FGeometryContext& Geo, const FSRVertexShaderOutput& A, const FSRVertexShaderOutput& B, const FSRVertexShaderOutput& C)
+{
 #if SR_ENABLE_PERFORMACE_STAT
 	FPerformanceCounter	PerfCounter;
-	FSR_Performance *Stats = InContext._pointers_shadow._stats;
+	FSR_Performance *Stats = Geo._stats;
 	double elapse_microseconds = 0.0;
-#endif
-
-#if SR_ENABLE_PERFORMACE_STAT
-	PerfCounter.StartPerf();
-#endif
-
-	FSR_VertexShader *vs = InContext._pointers_shadow._vs;
-	assert(vs);
-
-	vs->Process(InContext, InA, InCtx._clip_vtx_buffer0[0]);
-	vs->Process(InContext, InB, InCtx._clip_vtx_buffer0[1]);
-	vs->Process(InContext, InC, InCtx._clip_vtx_buffer0[2]);
-
-#if SR_ENABLE_PERFORMACE_STAT
-	elapse_microseconds = PerfCounter.EndPerf();
 
 	Stats->_triangles_count++;
 	Stats->_vertexes_count += 3;
-	Stats->_vs_invoke_count += 3;
-	Stats->_vs_total_microseconds += elapse_microseconds;
 #endif
 
 #if SR_ENABLE_PERFORMACE_STAT
@@ -882,9 +1091,9 @@ void FSR_Renderer::DrawTriangle(const FSR_Context& InContext, const FSRVertex& I
 	// frustum culling
 	bool bOutsideOfVolume = false;
 	{
-		const glm::vec4& homogeneous_v0 = InCtx._clip_vtx_buffer0[0]._vertex;
-		const glm::vec4& homogeneous_v1 = InCtx._clip_vtx_buffer0[1]._vertex;
-		const glm::vec4& homogeneous_v2 = InCtx._clip_vtx_buffer0[2]._vertex;
+		const glm::vec4& homogeneous_v0 = A._vertex;
+		const glm::vec4& homogeneous_v1 = B._vertex;
+		const glm::vec4& homogeneous_v2 = C._vertex;
 
 		bOutsideOfVolume =
 			IsOnNegtiveSideOf_LeftPlane(homogeneous_v0, homogeneous_v1, homogeneous_v2) ||
@@ -906,19 +1115,40 @@ void FSR_Renderer::DrawTriangle(const FSR_Context& InContext, const FSRVertex& I
 		return; // DISCARD!
 	}
 
+	// clipping would output the same triangle
+	if (IsInsideOfVolume(A._vertex) && IsInsideOfVolume(B._vertex) && IsInsideOfVolume(C._vertex))
+	{
+#if SR_ENABLE_PERFORMACE_STAT
+		PerfCounter.StartPerf();
+#endif
+		RasterizeTriangle(Geo, A, B, C);
+
+#if SR_ENABLE_PERFORMACE_STAT
+		elapse_microseconds = PerfCounter.EndPerf();
+
+		Stats->_raster_invoked_count++;
+		Stats->_raster_total_microseconds += elapse_microseconds;
+#endif
+		return;
+	}
+
 #if SR_ENABLE_PERFORMACE_STAT
 	PerfCounter.StartPerf();
 #endif
 
+	Geo._clip_vtx_buffer0[0] = A;
+	Geo._clip_vtx_buffer0[1] = B;
+	Geo._clip_vtx_buffer0[2] = C;
+
 #if 0 // DEBUG
-	InCtx._clip_vtx_buffer0[0]._attributes._members[0] = glm::vec4(1.0f, 0.f, 0.f, 1.f);
-	InCtx._clip_vtx_buffer0[1]._attributes._members[0] = glm::vec4(0.0f, 1.f, 0.f, 1.f);
-	InCtx._clip_vtx_buffer0[2]._attributes._members[0] = glm::vec4(0.0f, 0.f, 1.f, 1.f);
+	Geo._clip_vtx_buffer0[0]._attributes._members[0] = glm::vec4(1.0f, 0.f, 0.f, 1.f);
+	Geo._clip_vtx_buffer0[1]._attributes._members[0] = glm::vec4(0.0f, 1.f, 0.f, 1.f);
+	Geo._clip_vtx_buffer0[2]._attributes._members[0] = glm::vec4(0.0f, 0.f, 1.f, 1.f);
 #endif
 
 	uint32_t verts_cnt = 3;
-	FSRVertexShaderOutput* vtx_buffer0 = InCtx._clip_vtx_buffer0;
-	FSRVertexShaderOutput* vtx_buffer1 = InCtx._clip_vtx_buffer1;
+	FSRVertexShaderOutput* vtx_buffer0 = Geo._clip_vtx_buffer0;
+	FSRVertexShaderOutput* vtx_buffer1 = Geo._clip_vtx_buffer1;
 	for (uint32_t i = 0; (i < sizeof(kClipPlanes) / sizeof(kClipPlanes[0])) && verts_cnt >= 3; ++i)
 	{
 		verts_cnt = ClipAgainstPlane(vtx_buffer0, verts_cnt, kClipPlanes[i], vtx_buffer1);
@@ -948,7 +1178,7 @@ void FSR_Renderer::DrawTriangle(const FSR_Context& InContext, const FSRVertex& I
 	for (uint32_t i=2; i<verts_cnt; ++i)
 	{
 		iv2 = i;
-		RasterizeTriangle(InContext, vtx_buffer[iv0], vtx_buffer[iv1], vtx_buffer[iv2]);
+		RasterizeTriangle(Geo, vtx_buffer[iv0], vtx_buffer[iv1], vtx_buffer[iv2]);
 		iv1 = iv2;
 	}
 
@@ -961,269 +1191,442 @@ void FSR_Renderer::DrawTriangle(const FSR_Context& InContext, const FSRVertex& I
 }
 
 
-// draw a mesh
-void FSR_Renderer::DrawMesh(FSR_Context& InContext, const FSR_Mesh& InMesh)
+// vertex shading, culling & clipping of a triangle
+static void ProcessTriangle(FGeometryContext& Geo, const FSRVertex& InA, const FSRVertex& InB, const FSRVertex& InC)
 {
-	const std::vector<FSRVertex> &VertexBuffer = InMesh._VertexBuffer;
-	const std::vector<uint32_t>& IndexBuffer = InMesh._IndexBuffer;;
-	const std::vector<std::shared_ptr<FSR_Material>>& Materials = InMesh._Materials;
+	const FSR_Context& InContext = *Geo._SRCtx;
 
-	for (uint32_t k=0; k<InMesh._SubMeshes.size(); ++k)
-	{
-		const FSR_Mesh::FSR_SubMesh& subMesh = InMesh._SubMeshes[k];
+#if SR_ENABLE_PERFORMACE_STAT
+	FPerformanceCounter	PerfCounter;
+	FSR_Performance *Stats = Geo._stats;
+	PerfCounter.StartPerf();
+#endif
 
-		if (subMesh._MaterialIndex != SR_INVALID_INDEX) {
-			InContext.SetMaterial(Materials[subMesh._MaterialIndex]);
-		}
-		
-		// draw triangles
-		const uint32_t triangleCount = subMesh._IndexCount / 3;
-		for (uint32_t idx = 0; idx < triangleCount; idx++)
-		{
-			const FSRVertex& V0 = VertexBuffer[IndexBuffer[subMesh._IndexOffset + (idx * 3)]];
-			const FSRVertex& V1 = VertexBuffer[IndexBuffer[subMesh._IndexOffset + (idx * 3 + 1)]];
-			const FSRVertex& V2 = VertexBuffer[IndexBuffer[subMesh._IndexOffset + (idx * 3 + 2)]];
+	FSR_VertexShader *vs = InContext._pointers_shadow._vs;
+	assert(vs);
 
-			DrawTriangle(InContext, V0, V1, V2);
-		}
+	FSRVertexShaderOutput VSOutput[3];
+	vs->Process(InContext, InA, VSOutput[0]);
+	vs->Process(InContext, InB, VSOutput[1]);
+	vs->Process(InContext, InC, VSOutput[2]);
 
-	} // end for k
-}
+#if SR_ENABLE_PERFORMACE_STAT
+	Stats->_vs_invoke_count += 3;
+	Stats->_vs_total_microseconds += PerfCounter.EndPerf();
+#endif
 
+	ProcessShadedTriangle(Geo, VSOutput[0], VSOutput[1], VSOutput[2]);
+}
 
-//////////////////////////////////////////////////////////////////////////
-//  Multi-Thread Tiled-Rendering
-//
-//////////////////////////////////////////////////////////////////////////
-#include <thread>
-#include <mutex>
-#include <condition_variable>
+void FSR_Renderer::DrawTriangle(const FSR_Context& InContext, const FSRVertex& InA, const FSRVertex& InB, const FSRVertex& InC)
+{
+	FSR_TileBins& Bins = *InContext._tile_bins;
 
+	FGeometryContext Geo;
+	Geo._SRCtx = &InContext;
+	Geo._DrawState = Bins.AcquireDrawState(InContext);
+	Geo._stats = InContext._stats.get();
+	Geo._bins = &Bins;
+	Geo._chunk = SR_INVALID_INDEX;
 
-typedef void (*pfnTileHandler)(const FTiledRenderingContext& InCtx);
+	ProcessTriangle(Geo, InA, InB, InC);
+}
 
-struct FTileCommand {
-	bool _terminate;
-	FTiledRenderingContext	_ctx;
-	pfnTileHandler	_handler;
-};
+// triangles per front-end job
+#define SR_GEOMETRY_CHUNK_SIZE	1024
 
-#define BUFFER_SIZE		32
-class FRingBuffer
+struct FGeometryChunksJob
 {
-public:
-	FRingBuffer() 
-		: _head(0)
-		, _tail(0)
-	{}
-
-	void Enqueue(const FTileCommand& InCmd);
-	void Dequeue(FTileCommand &cmd);
-	void WaitForEmpty();
-protected:
-	bool IsFull() { return ((_tail + 1) % BUFFER_SIZE) == _head; }
-	bool IsEmpty() { return _head == _tail; }
-protected:
-	FTileCommand _cmdbuffer[BUFFER_SIZE];
-	int _head, _tail;
-
-	std::mutex	_mutex;
-	std::condition_variable _cv;
+	const FSR_Context*		_SRCtx;
+	const FSR_DrawState*	_DrawState;
+	FSR_TileBins*			_bins;
+
+	const FSRVertexShaderOutput*	_vertices; // post-transform
+	const uint32_t*		_indices; // first index of the sub-mesh
+	uint32_t			_triangle_count;
+
+#if SR_ENABLE_PERFORMACE_STAT
+	std::vector<FSR_Performance> _stats;
+#endif
 };
 
-void FRingBuffer::Enqueue(const FTileCommand& InCmd)
+static void ProcessGeometryChunk(void* InData, uint32_t InChunk)
 {
-	std::unique_lock<std::mutex> lock(_mutex);
+	SR_TRACE_SCOPE_ARG("GeometryChunk", InChunk);
+	FGeometryChunksJob& Job = *static_cast<FGeometryChunksJob*>(InData);
 
-	while (IsFull()) {
-		_cv.wait(lock);
+	FGeometryContext Geo;
+	Geo._SRCtx = Job._SRCtx;
+	Geo._DrawState = Job._DrawState;
+#if SR_ENABLE_PERFORMACE_STAT
+	Geo._stats = &Job._stats[InChunk];
+#else
+	Geo._stats = nullptr;
+#endif
+	Geo._bins = Job._bins;
+	Geo._chunk = InChunk;
+
+	const uint32_t first = InChunk * SR_GEOMETRY_CHUNK_SIZE;
+	const uint32_t last = std::min(first + SR_GEOMETRY_CHUNK_SIZE, Job._triangle_count);
+	for (uint32_t idx = first; idx < last; ++idx)
+	{
+		const uint32_t* I = Job._indices + idx * 3;
+		ProcessShadedTriangle(Geo, Job._vertices[I[0]], Job._vertices[I[1]], Job._vertices[I[2]]);
 	}
+}
 
-	_cmdbuffer[_tail] = InCmd;
-	_tail = (_tail + 1) % BUFFER_SIZE;
+// vertices per vertex shading job
+#define SR_VERTEX_CHUNK_SIZE	2048
 
-	_cv.notify_all();
-}
+struct FVertexShadingJob
+{
+	const FSR_Context*		_SRCtx;
+	FSRVertexShaderBatch	_input;
+	FSRVertexShaderOutput*	_output;
+};
 
-void FRingBuffer::Dequeue(FTileCommand& OutCmd)
+static void ShadeVertexChunk(void* InData, uint32_t InChunk)
 {
-	std::unique_lock<std::mutex> lock(_mutex);
+	SR_TRACE_SCOPE_ARG("ShadeVertexChunk", InChunk);
+	const FVertexShadingJob& Job = *static_cast<const FVertexShadingJob*>(InData);
+	FSR_VertexShader* vs = Job._SRCtx->_pointers_shadow._vs;
 
-	while (IsEmpty()) {
-		_cv.wait(lock);
-	}
+	const uint32_t first = InChunk * SR_VERTEX_CHUNK_SIZE;
+	const uint32_t last = std::min(first + SR_VERTEX_CHUNK_SIZE, Job._input._count);
 
-	OutCmd = _cmdbuffer[_head];
-	_head = (_head + 1) % BUFFER_SIZE;
+	FSRVertexShaderBatch Batch;
+	Batch._inputs = Job._input._inputs + first;
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		Batch._positions[i] = Job._input._positions[i] ? Job._input._positions[i] + first : nullptr;
+	}
+	Batch._count = last - first;
 
-	_cv.notify_all();
+	vs->ProcessBatch(*Job._SRCtx, Batch, Job._output + first);
 }
 
-void FRingBuffer::WaitForEmpty()
+// draw a mesh
+void FSR_Renderer::DrawMesh(FSR_Context& InContext, const FSR_Mesh& InMesh)
 {
-	std::unique_lock<std::mutex> lock(_mutex);
+	SR_TRACE_SCOPE("DrawMesh");
+	const std::vector<FSRVertex> &VertexBuffer = InMesh._VertexBuffer;
+	const std::vector<uint32_t>& IndexBuffer = InMesh._IndexBuffer;;
+	const std::vector<std::shared_ptr<FSR_Material>>& Materials = InMesh._Materials;
+	FSR_TileBins& Bins = *InContext._tile_bins;
+
+	assert(InContext._pointers_shadow._vs);
+
+#if SR_ENABLE_PERFORMACE_STAT
+	FPerformanceCounter	PerfCounter;
+	PerfCounter.StartPerf();
+#endif
 
-	while (!IsEmpty()) {
-		_cv.wait(lock);
+	// shade each vertex once, triangles are assembled from the post-transform vertices.
+	// they are only referenced during this draw, set-up copies the attributes.
+	FSR_LinearArena& VertexArena = *InContext._vertex_arena;
+	VertexArena.Reset();
+	FSRVertexShaderOutput* ShadedVertices = VertexArena.AllocateArray<FSRVertexShaderOutput>(VertexBuffer.size());
+	for (size_t i = 0; i < VertexBuffer.size(); ++i)
+	{
+		new (ShadedVertices + i) FSRVertexShaderOutput();
 	}
-}
+#if SR_ENABLE_PERFORMACE_STAT
+	InContext._stats->_vertex_arena_peak_bytes = std::max<uint64_t>(InContext._stats->_vertex_arena_peak_bytes, VertexArena.BytesUsed());
+#endif
+	{
+		FVertexShadingJob Job;
+		Job._SRCtx = &InContext;
+		Job._input._inputs = VertexBuffer.data();
+		Job._input._count = static_cast<uint32_t>(VertexBuffer.size());
+		for (int32_t i = 0; i < 4; ++i)
+		{
+			const bool bHasStream = InMesh._PositionStreams[i].size() == VertexBuffer.size();
+			Job._input._positions[i] = bHasStream ? InMesh._PositionStreams[i].data() : nullptr;
+		}
+		// stale streams if the positions were edited without BuildPositionStreams()
+		assert(!Job._input._positions[0] || InMesh.PositionStreamsMatch());
+		Job._output = ShadedVertices;
 
+		const uint32_t chunkCount = (Job._input._count + SR_VERTEX_CHUNK_SIZE - 1) / SR_VERTEX_CHUNK_SIZE;
 
-#define TILES_X		6
-#define TILES_Y		6
+		if (InContext._bEnableMultiThreads && chunkCount > 1) {
+			FSR_JobSystem::sharedInstance().ParallelFor(&ShadeVertexChunk, &Job, chunkCount);
+		}
+		else {
+			for (uint32_t c = 0; c < chunkCount; ++c)
+			{
+				ShadeVertexChunk(&Job, c);
+			}
+		}
+	}
 
-class FTileRenderSystem
-{
-public:
-	static FTileRenderSystem& sharedInstance();
+#if SR_ENABLE_PERFORMACE_STAT
+	InContext._stats->_vs_invoke_count += VertexBuffer.size();
+	InContext._stats->_vs_total_microseconds += PerfCounter.EndPerf();
+#endif
+
+	for (uint32_t k=0; k<InMesh._SubMeshes.size(); ++k)
+	{
+		const FSR_Mesh::FSR_SubMesh& subMesh = InMesh._SubMeshes[k];
+		SR_TRACE_SCOPE_ARG("SubMesh", k);
+
+		if (subMesh._MaterialIndex != SR_INVALID_INDEX) {
+			InContext.SetMaterial(Materials[subMesh._MaterialIndex]);
+		}
+		
+		// draw triangles
+		const uint32_t triangleCount = subMesh._IndexCount / 3;
+		const uint32_t chunkCount = (triangleCount + SR_GEOMETRY_CHUNK_SIZE - 1) / SR_GEOMETRY_CHUNK_SIZE;
 
-	void Start();
-	void Terminate();
-	void FlushCommands();
+		if (!InContext._bEnableMultiThreads || chunkCount < 2)
+		{
+			FGeometryContext Geo;
+			Geo._SRCtx = &InContext;
+			Geo._DrawState = Bins.AcquireDrawState(InContext);
+			Geo._stats = InContext._stats.get();
+			Geo._bins = &Bins;
+			Geo._chunk = SR_INVALID_INDEX;
+
+			for (uint32_t idx = 0; idx < triangleCount; idx++)
+			{
+				const FSRVertexShaderOutput& V0 = ShadedVertices[IndexBuffer[subMesh._IndexOffset + (idx * 3)]];
+				const FSRVertexShaderOutput& V1 = ShadedVertices[IndexBuffer[subMesh._IndexOffset + (idx * 3 + 1)]];
+				const FSRVertexShaderOutput& V2 = ShadedVertices[IndexBuffer[subMesh._IndexOffset + (idx * 3 + 2)]];
 
-public:
-	FTileRenderSystem() {}
+				ProcessShadedTriangle(Geo, V0, V1, V2);
+			}
+			continue;
+		}
 
-	FRingBuffer _cmdbuffers[TILES_Y][TILES_X];
-	std::thread _threads[TILES_Y][TILES_X];
-};
+		// chunks run in any order on the workers, and are binned in submission order
+		FGeometryChunksJob Job;
+		Job._SRCtx = &InContext;
+		Job._DrawState = Bins.AcquireDrawState(InContext);
+		Job._bins = &Bins;
+		Job._vertices = ShadedVertices;
+		Job._indices = IndexBuffer.data() + subMesh._IndexOffset;
+		Job._triangle_count = triangleCount;
+#if SR_ENABLE_PERFORMACE_STAT
+		Job._stats.resize(chunkCount);
+#endif
 
-static void thread_callback(int tilex, int tiley)
-{
-	FTileRenderSystem& sharedSys = FTileRenderSystem::sharedInstance();
-	FRingBuffer& buffer = sharedSys._cmdbuffers[tiley][tilex];
-	FTileCommand cmd;
+		Bins.SetChunkCount(chunkCount);
+		FSR_JobSystem::sharedInstance().ParallelFor(&ProcessGeometryChunk, &Job, chunkCount);
 
-	while (1) {
-		buffer.Dequeue(cmd);
-		if (cmd._terminate)
+		for (uint32_t c = 0; c < chunkCount; ++c)
 		{
-			break;
+			Bins.AddChunkTriangles(c);
+#if SR_ENABLE_PERFORMACE_STAT
+			InContext._stats->Accumulate(Job._stats[c]);
+#endif
 		}
-		cmd._handler(cmd._ctx);
-	}
+	} // end for k
 }
 
-FTileRenderSystem& FTileRenderSystem::sharedInstance()
-{
-	static FTileRenderSystem shared;
 
-	return shared;
-}
+//////////////////////////////////////////////////////////////////////////
+//  Multi-Thread Tiled-Rendering
+//
+//////////////////////////////////////////////////////////////////////////
 
-void FTileRenderSystem::Start()
+// rasterize all triangles binned to a tile
+static bool RasterizeTriangle_Tile(const FTiledRenderingContext& InCtx, const int32_t X0, const int32_t Y0, const int32_t X1, const int32_t Y1, FSR_WorkerStats* Stats)
 {
-	for (int y = 0; y<TILES_Y; y++)
+	const FSR_DrawState& State = *InCtx._DrawState;
+
+	if (State._bEnableMSAA)
 	{
-		for (int x=0; x<TILES_X; x++)
-		{
-			_threads[y][x] = std::thread(&thread_callback, x, y);
+		if (State._bTypedTargets) {
+			RasterizeTriangleMSAA4_Tile<EPixelFormat::PIXEL_FORMAT_F32, EPixelFormat::PIXEL_FORMAT_RGBA8888>(InCtx, X0, Y0, X1, Y1, Stats);
 		}
+		else {
+			RasterizeTriangleMSAA4_Tile<EPixelFormat::PIXEL_FORMAT_MAX, EPixelFormat::PIXEL_FORMAT_MAX>(InCtx, X0, Y0, X1, Y1, Stats);
+		}
+		return false;
 	}
+
+	if (State._bTypedTargets) {
+		return RasterizeTriangleNormal_Tile<EPixelFormat::PIXEL_FORMAT_F32, EPixelFormat::PIXEL_FORMAT_RGBA8888>(InCtx, X0, Y0, X1, Y1, Stats);
+	}
+	return RasterizeTriangleNormal_Tile<EPixelFormat::PIXEL_FORMAT_MAX, EPixelFormat::PIXEL_FORMAT_MAX>(InCtx, X0, Y0, X1, Y1, Stats);
 }
 
-void FTileRenderSystem::Terminate()
+struct FTileRasterJob
+{
+	const FSR_TileBins*	_bins;
+	FSR_TileScheduler*	_scheduler;
+	FSR_WorkerStats*	_worker_stats; // indexed by FSR_JobSystem::ThreadSlot()
+	FSR_DebugHeatmaps*	_heatmaps;
+};
+
+// rasterize the triangles of a tile inside [RX0, RX1) x [RY0, RY1)
+static void RasterizeTileRect(const FTileRasterJob& Job, uint32_t InTileIndex, int32_t RX0, int32_t RY0, int32_t RX1, int32_t RY1, bool InbSplit, FSR_WorkerStats* Stats)
 {
-	FTileCommand Cmd;
+	const FSR_TileBins& Bins = *Job._bins;
+
+#if SR_ENABLE_PERFORMACE_STAT
+	FPerformanceCounter PerfCounter;
+	PerfCounter.StartPerf();
+	int32_t TX0, TY0, TX1, TY1;
+	Bins.GetTileRect(InTileIndex, TX0, TY0, TX1, TY1);
+	// once per tile, however it is split
+	Stats->_tiles_processed += (Bins.GetTileBin(InTileIndex)._head && RX0 == TX0 && RY0 == TY0) ? 1 : 0;
+#endif
 
-	Cmd._terminate = true;
-	for (int y = 0; y < TILES_Y; y++)
+	// the cells of a split tile are refreshed after the flush, they are valid until this job changes its blocks
+	bool bCellsValid = true;
+
+	for (const FSR_BinBlock* Block = Bins.GetTileBin(InTileIndex)._head; Block; Block = Block->_next)
 	{
-		for (int x = 0; x < TILES_X; x++)
+		for (uint32_t i = 0; i < Block->_count; ++i)
 		{
-			_cmdbuffers[y][x].Enqueue(Cmd);
-			_threads[y][x].join();
-		}
-	}
+			const FTiledRenderingContext& Tri = *Block->_triangles[i];
+
+			const int32_t X0 = std::max(Tri._X0, RX0);
+			const int32_t Y0 = std::max(Tri._Y0, RY0);
+			const int32_t X1 = std::min(Tri._X1, RX1);
+			const int32_t Y1 = std::min(Tri._Y1, RY1);
+			if (X0 >= X1 || Y0 >= Y1)
+			{
+				continue;
+			}
+
+			// whole triangle is behind the tile
+			if (Tri._DrawState->_bEnableHiZ && bCellsValid)
+			{
+				const FSR_HiZBuffer* hiz = Tri._DrawState->_Pointers._hiz;
+				if (Tri._MinZ - SR_HIZ_DEPTH_BIAS > hiz->GetMaxDepth(X0, Y0, X1, Y1))
+				{
+					continue;
+				}
+			}
+
+			if (RasterizeTriangle_Tile(Tri, X0, Y0, X1, Y1, Stats)) {
+				if (InbSplit) {
+					bCellsValid = false;
+				}
+				else {
+					// cells of the tile are only written by this job
+					Tri._DrawState->_Pointers._hiz->UpdateCells(RX0, RY0, RX1, RY1);
+				}
+			}
+		} // end for i
+	} // end for Block
+
+#if SR_ENABLE_PERFORMACE_STAT
+	Stats->_tile_total_microseconds += PerfCounter.EndPerf();
+#endif
 }
 
-void FTileRenderSystem::FlushCommands()
+static void RasterizeTileJob(void* InData, uint32_t InJobIndex)
 {
-	for (int y = 0; y < TILES_Y; y++)
+	SR_TRACE_SCOPE_ARG("RasterizeTile", InJobIndex);
+	const FTileRasterJob& Job = *static_cast<const FTileRasterJob*>(InData);
+	const FSR_TileBins& Bins = *Job._bins;
+	const FSR_TileJob& TileJob = Job._scheduler->GetJob(InJobIndex);
+	FSR_WorkerStats* Stats = Job._worker_stats + FSR_JobSystem::ThreadSlot();
+
+	// a split job is inside one tile, a merged one covers whole tiles
+	const uint32_t tx0 = TileJob._x0 / SR_TILE_SIZE;
+	const uint32_t ty0 = TileJob._y0 / SR_TILE_SIZE;
+	const uint32_t tx1 = (TileJob._x1 - 1) / SR_TILE_SIZE;
+	const uint32_t ty1 = (TileJob._y1 - 1) / SR_TILE_SIZE;
+
+	for (uint32_t ty = ty0; ty <= ty1; ++ty)
 	{
-		for (int x = 0; x < TILES_X; x++)
+		for (uint32_t tx = tx0; tx <= tx1; ++tx)
 		{
-			_cmdbuffers[y][x].WaitForEmpty();
+			const uint32_t TileIndex = ty * Bins.TilesX() + tx;
+			int32_t X0, Y0, X1, Y1;
+			Bins.GetTileRect(TileIndex, X0, Y0, X1, Y1);
+			X0 = std::max(X0, TileJob._x0);
+			Y0 = std::max(Y0, TileJob._y0);
+			X1 = std::min(X1, TileJob._x1);
+			Y1 = std::min(Y1, TileJob._y1);
+
+			const int64_t StartCycles = appCycles();
+			RasterizeTileRect(Job, TileIndex, X0, Y0, X1, Y1, TileJob._bSplit, Stats);
+			const uint64_t Cycles = static_cast<uint64_t>(appCycles() - StartCycles);
+
+			Job._scheduler->RecordCycles(InJobIndex, TileIndex, Cycles);
+#if SR_ENABLE_DEBUG_HEATMAPS
+			if (Job._heatmaps) {
+				Job._heatmaps->AddTileCycles(X0, Y0, X1, Y1, Cycles);
+			}
+#endif
 		}
 	}
 }
 
-static void MultiThreadsProcessTile(const FTiledRenderingContext& InCtx, void (*handler)(const FTiledRenderingContext& InCtx))
+bool FSR_Renderer::EnableMultiThreads(uint32_t InNumThreads)
 {
-	FTileRenderSystem& sharedSys = FTileRenderSystem::sharedInstance();
-
-	const FSR_Rectangle	&vprect = InCtx._SRCtx->_viewport_rect;
-	float X[TILES_X+1], Y[TILES_Y+1];
+	return FSR_JobSystem::sharedInstance().Start(InNumThreads);
+}
 
-	float dx = (int32_t)((vprect._maxx - vprect._minx) / TILES_X);
-	float dy = (int32_t)((vprect._maxy - vprect._miny) / TILES_Y);
-	int32_t k, i, j;
+void FSR_Renderer::Flush(FSR_Context& InContext)
+{
+	FSR_TileBins& Bins = *InContext._tile_bins;
 
-	for (k=1, X[0] = vprect._minx; k<TILES_X; k++)
+	if (Bins.IsEmpty())
 	{
-		X[k] = X[k - 1] + dx;
+		return;
 	}
-	X[k] = vprect._maxx;
+	SR_TRACE_SCOPE("FlushTiles");
 
-	for (k=1, Y[0] = vprect._miny; k<TILES_Y; k++)
+	// a counter block per thread that may run a tile
+	const uint32_t NumSlots = FSR_JobSystem::sharedInstance().NumThreadSlots();
+	if (InContext._worker_stats.size() < NumSlots)
 	{
-		Y[k] = Y[k - 1] + dy;
+		InContext._worker_stats.resize(NumSlots);
 	}
-	Y[k] = vprect._maxy;
 
+	// split the hot tiles & merge the cold ones, from the costs of the last frame
+	FSR_TileScheduler& Scheduler = *InContext._tile_scheduler;
+	Scheduler.Plan(Bins, InContext._bEnableMultiThreads ? NumSlots : 1);
 
-	FTileCommand cmd = { false, InCtx, handler };
-	FSR_Rectangle rect0, rect1, rect2;
-	rect0._minx = InCtx._X0;
-	rect0._miny = InCtx._Y0;
-	rect0._maxx = InCtx._X1;
-	rect0._maxy = InCtx._Y1;
+	FTileRasterJob Job;
+	Job._bins = &Bins;
+	Job._scheduler = &Scheduler;
+	Job._worker_stats = InContext._worker_stats.data();
+	Job._heatmaps = InContext._pointers_shadow._heatmaps;
 
-	for (i=0; i<TILES_Y; i++)
+	// any idle worker picks up the next job
+	if (InContext._bEnableMultiThreads) 
 	{
-		rect1._miny = Y[i];
-		rect1._maxy = Y[i + 1];
-		for (j=0; j<TILES_X; j++)
+		FSR_JobSystem::sharedInstance().ParallelFor(&RasterizeTileJob, &Job, Scheduler.JobCount());
+	}
+	else
+	{
+		for (uint32_t k = 0; k < Scheduler.JobCount(); ++k)
 		{
-			rect1._minx = X[j];
-			rect1._maxx = X[j + 1];
-			if (intersect(rect0, rect1, rect2)) {
-
-				cmd._ctx._X0 = rect2._minx;
-				cmd._ctx._Y0 = rect2._miny;
-				cmd._ctx._X1 = rect2._maxx;
-				cmd._ctx._Y1 = rect2._maxy;
-
-				sharedSys._cmdbuffers[i][j].Enqueue(cmd);
-			}
-		} // end for j
-	} // end for i
-}
-
-bool FSR_Renderer::EnableMultiThreads()
-{
-	FTileRenderSystem& shared = FTileRenderSystem::sharedInstance();
-
-	shared.Start();
-	return true;
-}
-
-void FSR_Renderer::Flush(FSR_Context& InContext)
-{
-	FTileRenderSystem& shared = FTileRenderSystem::sharedInstance();
+			RasterizeTileJob(&Job, k);
+		}
+	}
+	Scheduler.EndFlush();
 
-	if (InContext._bEnableMultiThreads) 
+	// the HiZ cells of the split tiles, skipped by their jobs
+	FSR_HiZBuffer* hiz = InContext._pointers_shadow._hiz;
+	for (uint32_t k = 0; k < Scheduler.JobCount() && hiz; ++k)
 	{
-		shared.FlushCommands();
+		const FSR_TileJob& TileJob = Scheduler.GetJob(k);
+		if (TileJob._bSplit)
+		{
+			hiz->UpdateCells(TileJob._x0, TileJob._y0, TileJob._x1, TileJob._y1);
+		}
 	}
+
+#if SR_ENABLE_PERFORMACE_STAT
+	InContext._stats->_bin_arena_peak_bytes = std::max<uint64_t>(InContext._stats->_bin_arena_peak_bytes, Bins.ArenaBytesUsed());
+#endif
+	Bins.Clear();
 }
 
 void FSR_Renderer::TerminateMultiThreads(FSR_Context& InContext)
 {
-	FTileRenderSystem& shared = FTileRenderSystem::sharedInstance();
-
 	if (InContext._bEnableMultiThreads)
 	{
-		shared.Terminate();
+		Flush(InContext);
+		FSR_JobSystem::sharedInstance().Terminate();
+		InContext._bEnableMultiThreads = false;
 	}
 }
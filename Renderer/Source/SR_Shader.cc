@@ -4,6 +4,139 @@
 
 #include "SR_Shader.h"
 #include "SR_Context.h"
+#include "SR_SIMD.h"
+
+
+void FSR_VertexShader::ProcessBatch(const FSR_Context& InContext, const FSRVertexShaderBatch& Input, FSRVertexShaderOutput* Output)
+{
+	for (uint32_t k = 0; k < Input._count; ++k)
+	{
+		Process(InContext, Input._inputs[k], Output[k]);
+	}
+}
+
+void FSR_PixelShader::ProcessWide(const FSRPixelShaderContext& InContext, const FSRPixelShaderWideInput& Input, FSRPixelShaderWideOutput& Output)
+{
+	FSRPixelShaderQuadInput Quad;
+	FSRPixelShaderQuadOutput QuadOutput;
+	const bool bDerivatives = UseDerivatives();
+
+	for (uint32_t q = 0; q < SR_SIMD_WIDTH / 4; ++q)
+	{
+		Quad._mask = (Input._mask >> (q * 4)) & 0xF;
+		if (!Quad._mask)
+		{
+			continue;
+		}
+
+		// SoA -> AoS, pixels 0, 1 & 2 give the derivatives
+		const uint32_t Lanes = bDerivatives ? (Quad._mask | 0x7) : Quad._mask;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (!(Lanes & (1 << i)))
+			{
+				continue;
+			}
+
+			FSRVertexAttributes& Attributes = Quad._pixels[i]._attributes;
+			Attributes._count = Input._count;
+			for (uint32_t k = 0; k < Input._count; ++k)
+			{
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					Attributes._members[k][c] = Input._attributes[k][c][q * 4 + i];
+				}
+			}
+		}
+		if (bDerivatives)
+		{
+			Quad._ddx._count = Quad._ddy._count = Input._count;
+			for (uint32_t k = 0; k < Input._count; ++k)
+			{
+				Quad._ddx._members[k] = Quad._pixels[1]._attributes._members[k] - Quad._pixels[0]._attributes._members[k];
+				Quad._ddy._members[k] = Quad._pixels[2]._attributes._members[k] - Quad._pixels[0]._attributes._members[k];
+			}
+		}
+
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			QuadOutput._pixels[i]._color_cnt = Output._color_cnt;
+		}
+		ProcessQuad(InContext, Quad, QuadOutput);
+
+		// AoS -> SoA
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (!(Quad._mask & (1 << i)))
+			{
+				continue;
+			}
+			for (uint32_t k = 0; k < Output._color_cnt; ++k)
+			{
+				for (uint32_t c = 0; c < 4; ++c)
+				{
+					Output._colors[k][c][q * 4 + i] = QuadOutput._pixels[i]._colors[k][c];
+				}
+			}
+		}
+	}
+}
+
+void FSR_PixelShader::ProcessQuad(const FSRPixelShaderContext& InContext, const FSRPixelShaderQuadInput& Input, FSRPixelShaderQuadOutput& Output)
+{
+	for (uint32_t k = 0; k < 4; ++k)
+	{
+		if (Input._mask & (1 << k))
+		{
+			Process(InContext, Input._pixels[k], Output._pixels[k]);
+		}
+	}
+}
+
+// Output[k]._vertex = M * position[k], SR_SIMD_WIDTH vertices a time.
+// returns the count of transformed vertices, the tail is left to the caller.
+static uint32_t TransformPositionsSoA(const glm::mat4x4& M, const FSRVertexShaderBatch& Input, FSRVertexShaderOutput* Output)
+{
+	if (!Input._positions[0] || !Input._positions[1] || !Input._positions[2] || !Input._positions[3])
+	{
+		return 0;
+	}
+
+	VectorRegisterWide C[4][4];
+	for (int32_t j = 0; j < 4; ++j)
+	{
+		for (int32_t i = 0; i < 4; ++i)
+		{
+			C[j][i] = WideSet1(M[j][i]);
+		}
+	}
+
+	alignas(32) float R[4][SR_SIMD_WIDTH];
+	const uint32_t count = Input._count - Input._count % SR_SIMD_WIDTH;
+
+	for (uint32_t k = 0; k < count; k += SR_SIMD_WIDTH)
+	{
+		const VectorRegisterWide X = WideLoad(Input._positions[0] + k);
+		const VectorRegisterWide Y = WideLoad(Input._positions[1] + k);
+		const VectorRegisterWide Z = WideLoad(Input._positions[2] + k);
+		const VectorRegisterWide W = WideLoad(Input._positions[3] + k);
+
+		for (int32_t i = 0; i < 4; ++i)
+		{
+			VectorRegisterWide V = WideMultiply(C[3][i], W);
+			V = WideMultiplyAdd(C[2][i], Z, V);
+			V = WideMultiplyAdd(C[1][i], Y, V);
+			V = WideMultiplyAdd(C[0][i], X, V);
+			WideStore(V, R[i]);
+		}
+
+		for (uint32_t l = 0; l < SR_SIMD_WIDTH; ++l)
+		{
+			Output[k + l]._vertex = glm::vec4(R[0][l], R[1][l], R[2][l], R[3][l]);
+		}
+	}
+	return count;
+}
 
 
 // simple vs & ps with color
@@ -23,6 +156,15 @@ void FSR_SimplePixelShader::Process(const FSRPixelShaderContext& InContext, cons
 	color.a = 1.f;
 }
 
+void FSR_SimplePixelShader::ProcessWide(const FSRPixelShaderContext& InContext, const FSRPixelShaderWideInput& Input, FSRPixelShaderWideOutput& Output)
+{
+	for (uint32_t c = 0; c < 3; ++c)
+	{
+		WideStore(WideLoad(Input._attributes[0][c]), Output._colors[0][c]);
+	}
+	WideStore(WideSet1(1.f), Output._colors[0][3]);
+}
+
 // depth only
 void FSR_DepthOnlyVertexShader::Process(const FSR_Context& InContext, const FSRVertexShaderInput& Input, FSRVertexShaderOutput& Output)
 {
@@ -30,6 +172,19 @@ void FSR_DepthOnlyVertexShader::Process(const FSR_Context& InContext, const FSRV
 	Output._attributes._count = 0;
 }
 
+void FSR_DepthOnlyVertexShader::ProcessBatch(const FSR_Context& InContext, const FSRVertexShaderBatch& Input, FSRVertexShaderOutput* Output)
+{
+	const uint32_t count = TransformPositionsSoA(InContext._mvps._mvp, Input, Output);
+	for (uint32_t k = 0; k < count; ++k)
+	{
+		Output[k]._attributes._count = 0;
+	}
+	for (uint32_t k = count; k < Input._count; ++k)
+	{
+		Process(InContext, Input._inputs[k], Output[k]);
+	}
+}
+
 void FSR_DepthOnlyPixelShader::Process(const FSRPixelShaderContext& InContext, const FSRPixelShaderInput& Input, FSRPixelShaderOutput& Output)
 {
 	// do nothing
@@ -43,6 +198,19 @@ void FSR_SimpleMeshVertexShader::Process(const FSR_Context& InContext, const FSR
 	Output._attributes = Input._attributes;
 }
 
+void FSR_SimpleMeshVertexShader::ProcessBatch(const FSR_Context& InContext, const FSRVertexShaderBatch& Input, FSRVertexShaderOutput* Output)
+{
+	const uint32_t count = TransformPositionsSoA(InContext._mvps._mvp, Input, Output);
+	for (uint32_t k = 0; k < count; ++k)
+	{
+		Output[k]._attributes = Input._inputs[k]._attributes;
+	}
+	for (uint32_t k = count; k < Input._count; ++k)
+	{
+		Process(InContext, Input._inputs[k], Output[k]);
+	}
+}
+
 void FSR_SimpleMeshPixelShader::Process(const FSRPixelShaderContext& InContext, const FSRPixelShaderInput& Input, FSRPixelShaderOutput& Output)
 {
 #if 0
@@ -51,7 +219,7 @@ void FSR_SimpleMeshPixelShader::Process(const FSRPixelShaderContext& InContext,
 	Output._color_cnt = 1;
 #else
 	const glm::vec4 &uv = Input._attributes._members[1];
-	float RGBA[4];
+	float RGBA[4] = { 1.f, 1.f, 1.f, 1.f }; // white without a diffuse texture
 	if (InContext._material && InContext._material->_diffuse_tex)
 	{
 		InContext._material->_diffuse_tex->Sample2DNearest(uv.x, uv.y, RGBA);
@@ -60,3 +228,61 @@ void FSR_SimpleMeshPixelShader::Process(const FSRPixelShaderContext& InContext,
 	memcpy(&Output._colors[0].r, RGBA, sizeof(RGBA));
 #endif
 }
+
+void FSR_SimpleMeshPixelShader::ProcessQuad(const FSRPixelShaderContext& InContext, const FSRPixelShaderQuadInput& Input, FSRPixelShaderQuadOutput& Output)
+{
+	const FSR_Texture2D* tex = InContext._material ? InContext._material->_diffuse_tex.get() : nullptr;
+
+	// same mip as ProcessWide(), from the uv derivatives of the quad
+	const float Lod = tex ? tex->ComputeLod(Input._ddx._members[1].x, Input._ddx._members[1].y, Input._ddy._members[1].x, Input._ddy._members[1].y) : 0.f;
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		if (!(Input._mask & (1 << i)))
+		{
+			continue;
+		}
+
+		const glm::vec4& uv = Input._pixels[i]._attributes._members[1];
+		float RGBA[4] = { 1.f, 1.f, 1.f, 1.f }; // white without a diffuse texture
+		if (tex)
+		{
+			tex->Sample2DNearestMip(uv.x, uv.y, Lod, RGBA);
+		}
+		memcpy(&Output._pixels[i]._colors[0].r, RGBA, sizeof(RGBA));
+	}
+}
+
+void FSR_SimpleMeshPixelShader::ProcessWide(const FSRPixelShaderContext& InContext, const FSRPixelShaderWideInput& Input, FSRPixelShaderWideOutput& Output)
+{
+	// white without a diffuse texture, as Process()
+	if (!InContext._material || !InContext._material->_diffuse_tex)
+	{
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			WideStore(WideSet1(1.f), Output._colors[0][c]);
+		}
+		return;
+	}
+
+	// fetch the texels of the active lanes, from the mip of their quad
+	const FSR_Texture2D* tex = InContext._material->_diffuse_tex.get();
+	const float* U = Input._attributes[1][0];
+	const float* V = Input._attributes[1][1];
+	float Lods[SR_SIMD_WIDTH / 4];
+	for (uint32_t q = 0; q < SR_SIMD_WIDTH / 4; ++q)
+	{
+		// helper pixels are interpolated too, pixels 0, 1 & 2 give the derivatives
+		const uint32_t l = q * 4;
+		Lods[q] = tex->ComputeLod(U[l + 1] - U[l], V[l + 1] - V[l], U[l + 2] - U[l], V[l + 2] - V[l]);
+	}
+	for (uint32_t Lanes = Input._mask; Lanes; Lanes &= Lanes - 1)
+	{
+		const uint32_t l = CountTrailingZeros(Lanes);
+		float RGBA[4];
+		tex->Sample2DNearestMip(U[l], V[l], Lods[l >> 2], RGBA);
+		for (uint32_t c = 0; c < 4; ++c)
+		{
+			Output._colors[0][c][l] = RGBA[c];
+		}
+	}
+}
@@ -0,0 +1,182 @@
+// \brief
+//		sort-middle binning
+//
+
+#include "SR_TileBins.h"
+#include "SR_Buffer2D.h"
+
+
+FSR_TileBins::FSR_TileBins()
+	: _w(0)
+	, _h(0)
+	, _tiles_x(0)
+	, _tiles_y(0)
+	, _current_state(nullptr)
+	, _bFarDepthWrites(false)
+	, _triangle_count(0)
+{
+}
+
+void FSR_TileBins::SetFrameSize(uint32_t w, uint32_t h)
+{
+	assert(IsEmpty());
+	if (_w == w && _h == h)
+	{
+		return;
+	}
+
+	_w = w;
+	_h = h;
+	_tiles_x = (w + SR_TILE_SIZE - 1) / SR_TILE_SIZE;
+	_tiles_y = (h + SR_TILE_SIZE - 1) / SR_TILE_SIZE;
+	_bins.assign(_tiles_x * _tiles_y, FSR_TileBin{ nullptr, nullptr });
+}
+
+void FSR_TileBins::Clear()
+{
+	for (FSR_TileBin& bin : _bins)
+	{
+		bin._head = bin._tail = nullptr;
+	}
+	_triangle_count = 0;
+	_draw_states.clear();
+	_current_state = nullptr;
+	_bFarDepthWrites = false;
+
+	// nothing refers to the arenas any more
+	_arena.Reset();
+	for (std::unique_ptr<FSR_BinChunk>& chunk : _chunks)
+	{
+		assert(chunk->_triangles.empty());
+		chunk->_arena.Reset();
+	}
+}
+
+size_t FSR_TileBins::ArenaBytesUsed() const
+{
+	size_t bytes = _arena.BytesUsed();
+	for (const std::unique_ptr<FSR_BinChunk>& chunk : _chunks)
+	{
+		bytes += chunk->_arena.BytesUsed();
+	}
+	return bytes;
+}
+
+const FSR_DrawState* FSR_TileBins::AcquireDrawState(const FSR_Context& InContext)
+{
+	if (_current_state)
+	{
+		return _current_state;
+	}
+
+	// the grid follows the render target, which can only change after a flush
+	if (IsEmpty())
+	{
+		assert(InContext._pointers_shadow._rt_depth);
+		SetFrameSize(InContext._pointers_shadow._rt_depth->Width(), InContext._pointers_shadow._rt_depth->Height());
+	}
+
+	_draw_states.emplace_back();
+	FSR_DrawState& State = _draw_states.back();
+
+	State._SRCtx = &InContext;
+	State._Pointers = InContext._pointers_shadow;
+	State._psCtx._mvps = InContext._mvps;
+	State._psCtx._material = InContext._pointers_shadow._material;
+	State._bEnableMSAA = InContext._bEnableMSAA;
+
+	State._depth_func = InContext._depth_func;
+	State._bDepthWrite = InContext._bDepthWrite && (InContext._depth_func != ECompareFunc::COMPARE_NEVER);
+	State._color_write_mask = InContext._color_write_mask;
+	State._bDepthOnly = (InContext._color_write_mask == COLOR_WRITE_NONE) || (InContext._ps->OutputColorCount() == 0);
+
+	// the common target formats have a specialized rasterizer
+	const FSR_Context::FPointersShadow& Pointers = InContext._pointers_shadow;
+	FSR_DepthBuffer* const rt_depth = InContext._bEnableMSAA ? Pointers._rt_depth_msaa : Pointers._rt_depth;
+	FSR_Texture2D* const* rt_colors = InContext._bEnableMSAA ? Pointers._rt_colors_msaa : Pointers._rt_colors;
+	State._bTypedTargets = (rt_depth->Format() == EPixelFormat::PIXEL_FORMAT_F32);
+	for (uint32_t k = 0; k < InContext._ps->OutputColorCount() && !State._bDepthOnly; ++k)
+	{
+		State._bTypedTargets &= (rt_colors[k] && rt_colors[k]->Format() == EPixelFormat::PIXEL_FORMAT_RGBA8888);
+	}
+
+	// MSAA tests the depth of the samples, not of _rt_depth.
+	// the max depth only culls for tests which never pass behind the stored depth.
+	const bool bHiZ = !InContext._bEnableMSAA && (InContext._pointers_shadow._hiz != nullptr);
+	State._bEnableHiZ = bHiZ && 
+		(State._depth_func == ECompareFunc::COMPARE_LESS || 
+		 State._depth_func == ECompareFunc::COMPARE_LESS_EQUAL || 
+		 State._depth_func == ECompareFunc::COMPARE_EQUAL);
+	State._bUpdateHiZ = bHiZ && State._bDepthWrite;
+
+	// the HiZ of earlier flushes only bounds the depth while the writes of this flush pass a less test.
+	// the tile rasterizer tests the cells updated by the binned triangles instead.
+	_bFarDepthWrites |= State._bDepthWrite && 
+		State._depth_func != ECompareFunc::COMPARE_LESS && 
+		State._depth_func != ECompareFunc::COMPARE_LESS_EQUAL && 
+		State._depth_func != ECompareFunc::COMPARE_EQUAL;
+	State._bBinCullHiZ = State._bEnableHiZ && !_bFarDepthWrites;
+	State._ps = InContext._ps;
+	State._material = InContext._material;
+
+	_current_state = &State;
+	return _current_state;
+}
+
+void FSR_TileBins::AddTriangle(const FTiledRenderingContext& InTriangle)
+{
+	BinTriangle(CopyTriangle(_arena, InTriangle));
+}
+
+void FSR_TileBins::BinTriangle(const FTiledRenderingContext* InTriangle)
+{
+	++_triangle_count;
+
+	// tiles overlapped by the bounding box, [tx0, tx1] x [ty0, ty1]
+	const int32_t tx0 = std::min<int32_t>(InTriangle->_X0 / SR_TILE_SIZE, _tiles_x - 1);
+	const int32_t ty0 = std::min<int32_t>(InTriangle->_Y0 / SR_TILE_SIZE, _tiles_y - 1);
+	const int32_t tx1 = std::min<int32_t>((InTriangle->_X1 - 1) / SR_TILE_SIZE, _tiles_x - 1);
+	const int32_t ty1 = std::min<int32_t>((InTriangle->_Y1 - 1) / SR_TILE_SIZE, _tiles_y - 1);
+
+	for (int32_t ty = ty0; ty <= ty1; ++ty)
+	{
+		for (int32_t tx = tx0; tx <= tx1; ++tx)
+		{
+			FSR_TileBin& bin = _bins[ty * _tiles_x + tx];
+			if (!bin._tail || bin._tail->_count == SR_BIN_BLOCK_SIZE)
+			{
+				FSR_BinBlock* block = _arena.AllocateArray<FSR_BinBlock>(1);
+				block->_next = nullptr;
+				block->_count = 0;
+				if (bin._tail) {
+					bin._tail->_next = block;
+				}
+				else {
+					bin._head = block;
+				}
+				bin._tail = block;
+			}
+			bin._tail->_triangles[bin._tail->_count++] = InTriangle;
+		}
+	}
+}
+
+void FSR_TileBins::SetChunkCount(uint32_t InCount)
+{
+	while (_chunks.size() < InCount)
+	{
+		_chunks.emplace_back(new FSR_BinChunk());
+	}
+}
+
+void FSR_TileBins::AddChunkTriangles(uint32_t InChunk)
+{
+	std::vector<const FTiledRenderingContext*>& triangles = _chunks[InChunk]->_triangles;
+
+	// the triangles stay in the chunk arena until Clear()
+	for (const FTiledRenderingContext* tri : triangles)
+	{
+		BinTriangle(tri);
+	}
+	triangles.clear();
+}
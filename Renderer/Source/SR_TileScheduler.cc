@@ -0,0 +1,173 @@
+// \brief
+//		adaptive tile jobs
+//
+
+#include "SR_TileScheduler.h"
+#include <algorithm>
+#include "SR_TileBins.h"
+#include "SR_HiZ.h"
+
+
+// largest power of two <= InValue (InValue > 0)
+static uint32_t FloorPowerOfTwo(uint32_t InValue)
+{
+	uint32_t p = 1;
+	while (p <= InValue / 2)
+	{
+		p *= 2;
+	}
+	return p;
+}
+
+FSR_TileScheduler::FSR_TileScheduler()
+	: _min_size(SR_TILE_JOB_MIN_SIZE)
+	, _max_size(SR_TILE_JOB_MAX_SIZE)
+	, _tiles_x(0)
+	, _tiles_y(0)
+{
+}
+
+void FSR_TileScheduler::SetSizeRange(uint32_t InMinSize, uint32_t InMaxSize)
+{
+	// a split job owns whole HiZ blocks
+	_min_size = FloorPowerOfTwo(std::min<uint32_t>(std::max<uint32_t>(InMinSize, SR_HIZ_BLOCK_SIZE), SR_TILE_SIZE));
+	_max_size = FloorPowerOfTwo(std::min<uint32_t>(std::max<uint32_t>(InMaxSize, SR_TILE_SIZE), 1u << 16));
+}
+
+void FSR_TileScheduler::BeginFrame()
+{
+	_last_cycles.swap(_frame_cycles);
+	std::fill(_frame_cycles.begin(), _frame_cycles.end(), 0);
+}
+
+void FSR_TileScheduler::Plan(const FSR_TileBins& InBins, uint32_t InNumThreads)
+{
+	_jobs.clear();
+
+	// the costs are per tile of the grid
+	if (_tiles_x != InBins.TilesX() || _tiles_y != InBins.TilesY())
+	{
+		_tiles_x = InBins.TilesX();
+		_tiles_y = InBins.TilesY();
+		_last_cycles.assign(InBins.TileCount(), 0);
+		_frame_cycles.assign(InBins.TileCount(), 0);
+	}
+
+	uint64_t total = 0;
+	for (uint64_t cycles : _last_cycles)
+	{
+		total += cycles;
+	}
+
+	if (InNumThreads <= 1 || total == 0)
+	{
+		for (uint32_t ty = 0; ty < _tiles_y; ++ty)
+		{
+			for (uint32_t tx = 0; tx < _tiles_x; ++tx)
+			{
+				PlanRegion(InBins, tx, ty, 1, UINT64_MAX);
+			}
+		}
+		return;
+	}
+
+	const uint64_t target = std::max<uint64_t>(1, total / (InNumThreads * SR_TILE_JOBS_PER_THREAD));
+	const uint32_t n = _max_size / SR_TILE_SIZE;
+	for (uint32_t ty = 0; ty < _tiles_y; ty += n)
+	{
+		for (uint32_t tx = 0; tx < _tiles_x; tx += n)
+		{
+			PlanRegion(InBins, tx, ty, n, target);
+		}
+	}
+
+	// the long jobs start first, the short ones fill the gaps at the end
+	std::stable_sort(_jobs.begin(), _jobs.end(), [](const FSR_TileJob& a, const FSR_TileJob& b) {
+		return a._estimate > b._estimate;
+	});
+}
+
+uint64_t FSR_TileScheduler::RegionCost(uint32_t tx, uint32_t ty, uint32_t n) const
+{
+	const uint32_t tx1 = std::min(tx + n, _tiles_x);
+	const uint32_t ty1 = std::min(ty + n, _tiles_y);
+
+	uint64_t cost = 0;
+	for (uint32_t y = ty; y < ty1; ++y)
+	{
+		for (uint32_t x = tx; x < tx1; ++x)
+		{
+			cost += _last_cycles[y * _tiles_x + x];
+		}
+	}
+	return cost;
+}
+
+// n x n tiles at (tx, ty): one job if cheap enough, else the quadrants
+void FSR_TileScheduler::PlanRegion(const FSR_TileBins& InBins, uint32_t tx, uint32_t ty, uint32_t n, uint64_t InTarget)
+{
+	if (tx >= _tiles_x || ty >= _tiles_y)
+	{
+		return;
+	}
+	if (n == 1)
+	{
+		PlanTile(InBins, tx, ty, InTarget);
+		return;
+	}
+
+	const uint64_t cost = RegionCost(tx, ty, n);
+	if (cost > InTarget)
+	{
+		const uint32_t half = n / 2;
+		PlanRegion(InBins, tx, ty, half, InTarget);
+		PlanRegion(InBins, tx + half, ty, half, InTarget);
+		PlanRegion(InBins, tx, ty + half, half, InTarget);
+		PlanRegion(InBins, tx + half, ty + half, half, InTarget);
+		return;
+	}
+
+	// from the first to the last tile of the region
+	int32_t First[4], Last[4];
+	InBins.GetTileRect(ty * _tiles_x + tx, First[0], First[1], First[2], First[3]);
+	InBins.GetTileRect((std::min(ty + n, _tiles_y) - 1) * _tiles_x + std::min(tx + n, _tiles_x) - 1, Last[0], Last[1], Last[2], Last[3]);
+	_jobs.push_back(FSR_TileJob{ First[0], First[1], Last[2], Last[3], ty * _tiles_x + tx, false, cost, 0 });
+}
+
+// split the tile while its parts cost more than the target
+void FSR_TileScheduler::PlanTile(const FSR_TileBins& InBins, uint32_t tx, uint32_t ty, uint64_t InTarget)
+{
+	const uint32_t tile = ty * _tiles_x + tx;
+	const uint64_t cost = _last_cycles[tile];
+
+	uint32_t size = SR_TILE_SIZE;
+	uint32_t parts = 1;
+	while (size / 2 >= _min_size && cost / parts > InTarget)
+	{
+		size /= 2;
+		parts *= 4;
+	}
+
+	int32_t TX0, TY0, TX1, TY1;
+	InBins.GetTileRect(tile, TX0, TY0, TX1, TY1);
+	for (int32_t y = TY0; y < TY1; y += size)
+	{
+		for (int32_t x = TX0; x < TX1; x += size)
+		{
+			const int32_t x1 = std::min<int32_t>(x + size, TX1);
+			const int32_t y1 = std::min<int32_t>(y + size, TY1);
+			_jobs.push_back(FSR_TileJob{ x, y, x1, y1, tile, parts > 1, cost / parts, 0 });
+		}
+	}
+}
+
+void FSR_TileScheduler::EndFlush()
+{
+	for (const FSR_TileJob& job : _jobs)
+	{
+		if (job._bSplit)
+		{
+			_frame_cycles[job._tile] += job._cycles;
+		}
+	}
+}
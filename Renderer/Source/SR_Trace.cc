@@ -0,0 +1,123 @@
+// \brief
+//	scoped trace events.
+//
+
+#include <cstdio>
+#include "SR_Trace.h"
+
+
+static thread_local FSR_TraceBuffer* GThreadTraceBuffer = nullptr;
+
+FSR_TraceBuffer::FSR_TraceBuffer(uint32_t InThreadId, const char* InThreadName)
+	: _thread_id(InThreadId)
+	, _thread_name(InThreadName)
+	, _events(new FSR_TraceEvent[SR_TRACE_EVENTS_PER_THREAD])
+	, _count(0)
+	, _dropped(0)
+{
+}
+
+FSR_Trace& FSR_Trace::sharedInstance()
+{
+	static FSR_Trace shared;
+
+	return shared;
+}
+
+void FSR_Trace::Start()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	for (std::unique_ptr<FSR_TraceBuffer>& buffer : _buffers)
+	{
+		buffer->_count.store(0, std::memory_order_relaxed);
+		buffer->_dropped.store(0, std::memory_order_relaxed);
+	}
+	_bCapturing.store(true, std::memory_order_release);
+}
+
+void FSR_Trace::Stop()
+{
+	_bCapturing.store(false, std::memory_order_release);
+}
+
+void FSR_Trace::SetThreadName(const char* InName)
+{
+	FSR_TraceBuffer& buffer = ThreadBuffer();
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	buffer._thread_name = InName;
+}
+
+FSR_TraceBuffer& FSR_Trace::ThreadBuffer()
+{
+	if (!GThreadTraceBuffer)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		const uint32_t thread_id = static_cast<uint32_t>(_buffers.size());
+		char name[32];
+		snprintf(name, sizeof(name), "Thread %u", thread_id);
+		_buffers.emplace_back(new FSR_TraceBuffer(thread_id, name));
+		GThreadTraceBuffer = _buffers.back().get();
+	}
+	return *GThreadTraceBuffer;
+}
+
+// event names are identifiers, only quotes & backslashes are escaped
+static void WriteJsonString(FILE* InFile, const char* InString)
+{
+	fputc('"', InFile);
+	for (const char* p = InString; *p; ++p)
+	{
+		if (*p == '"' || *p == '\\')
+		{
+			fputc('\\', InFile);
+		}
+		fputc(*p, InFile);
+	}
+	fputc('"', InFile);
+}
+
+bool FSR_Trace::WriteChromeTrace(const char* InFilename) const
+{
+	FILE* file = fopen(InFilename, "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool bFirst = true;
+	for (const std::unique_ptr<FSR_TraceBuffer>& buffer : _buffers)
+	{
+		fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", bFirst ? "" : ",\n", buffer->_thread_id);
+		WriteJsonString(file, buffer->_thread_name.c_str());
+		fprintf(file, "}}");
+		bFirst = false;
+
+		const uint32_t count = buffer->_count.load(std::memory_order_acquire);
+		for (uint32_t k = 0; k < count; ++k)
+		{
+			const FSR_TraceEvent& e = buffer->_events[k];
+			fprintf(file, ",\n{\"name\":");
+			WriteJsonString(file, e._name);
+			fprintf(file, ",\"cat\":\"sr\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", buffer->_thread_id, e._begin_microseconds, e._duration_microseconds);
+			if (e._arg != SR_INVALID_INDEX)
+			{
+				fprintf(file, ",\"args\":{\"index\":%lld}", static_cast<long long>(e._arg));
+			}
+			fprintf(file, "}");
+		} // end for k
+
+		const uint32_t dropped = buffer->_dropped.load(std::memory_order_relaxed);
+		if (dropped)
+		{
+			fprintf(stderr, "trace: %u events of %s dropped\n", dropped, buffer->_thread_name.c_str());
+		}
+	} // end for buffer
+	fprintf(file, "\n]}\n");
+
+	fclose(file);
+	return true;
+}
@@ -0,0 +1,36 @@
+// \brief
+//		camera path of the benchmark
+//
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Camera.h"
+
+
+// key-framed camera, evaluated by the normalized time of the run
+class FBenchCameraPath
+{
+public:
+	struct FKey
+	{
+		glm::vec3	_position;
+		float		_yaw;
+		float		_pitch;
+	};
+
+	// the recorded path of a demo scene: quad, cubes, sponza, teapot
+	bool LoadCanned(const std::string& InSceneName);
+	// text file, one key per line: x y z yaw pitch, '#' starts a comment
+	bool LoadFromFile(const std::string& InFilename);
+
+	// InTime in [0, 1], keys are evenly spaced & linearly interpolated
+	void Evaluate(float InTime, FCamera& OutCamera) const;
+
+	bool IsEmpty() const { return _keys.empty(); }
+	size_t KeyCount() const { return _keys.size(); }
+
+protected:
+	std::vector<FKey>	_keys;
+};
@@ -0,0 +1,116 @@
+// BenchCameraPath.cc
+//
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include "BenchCameraPath.h"
+
+#define ARR_SIZE(x) (sizeof(x) / sizeof(x[0]))
+
+
+// paths loop back to their first key, a positive pitch looks down
+static const FBenchCameraPath::FKey kQuadPath[] =
+{
+	{ glm::vec3(0.f, 0.f, 10.f), 0.f, 0.f },
+	{ glm::vec3(3.f, 0.f, 8.f), 20.f, 0.f },
+	{ glm::vec3(0.f, 2.f, 6.f), 0.f, 15.f },
+	{ glm::vec3(-3.f, 0.f, 8.f), -20.f, 0.f },
+	{ glm::vec3(0.f, 0.f, 10.f), 0.f, 0.f },
+};
+
+static const FBenchCameraPath::FKey kCubesPath[] =
+{
+	{ glm::vec3(0.f, 3.75f, 6.5f), 0.f, 30.f },
+	{ glm::vec3(5.f, 3.f, 5.f), 40.f, 25.f },
+	{ glm::vec3(0.f, 2.f, 9.f), 0.f, 10.f },
+	{ glm::vec3(-5.f, 3.f, 5.f), -40.f, 25.f },
+	{ glm::vec3(0.f, 3.75f, 6.5f), 0.f, 30.f },
+};
+
+static const FBenchCameraPath::FKey kSponzaPath[] =
+{
+	{ glm::vec3(0.f, -8.5f, -5.f), -90.f, 0.f },
+	{ glm::vec3(20.f, -8.5f, -5.f), -90.f, 5.f },
+	{ glm::vec3(20.f, -6.f, -5.f), -30.f, 15.f },
+	{ glm::vec3(-20.f, -6.f, -5.f), 30.f, 10.f },
+	{ glm::vec3(-20.f, -8.5f, -5.f), 90.f, 0.f },
+	{ glm::vec3(0.f, -8.5f, -5.f), -90.f, 0.f },
+};
+
+static const FBenchCameraPath::FKey kTeapotPath[] =
+{
+	{ glm::vec3(0.f, 2.f, 2.f), 0.f, 45.f },
+	{ glm::vec3(1.5f, 1.5f, 2.5f), 30.f, 30.f },
+	{ glm::vec3(0.f, 1.f, 3.f), 0.f, 20.f },
+	{ glm::vec3(-1.5f, 1.5f, 2.5f), -30.f, 30.f },
+	{ glm::vec3(0.f, 2.f, 2.f), 0.f, 45.f },
+};
+
+bool FBenchCameraPath::LoadCanned(const std::string& InSceneName)
+{
+	const FKey* Keys = nullptr;
+	size_t Count = 0;
+	if (InSceneName == "quad") { Keys = kQuadPath; Count = ARR_SIZE(kQuadPath); }
+	else if (InSceneName == "cubes") { Keys = kCubesPath; Count = ARR_SIZE(kCubesPath); }
+	else if (InSceneName == "sponza") { Keys = kSponzaPath; Count = ARR_SIZE(kSponzaPath); }
+	else if (InSceneName == "teapot") { Keys = kTeapotPath; Count = ARR_SIZE(kTeapotPath); }
+	else
+	{
+		return false;
+	}
+
+	_keys.assign(Keys, Keys + Count);
+	return true;
+}
+
+bool FBenchCameraPath::LoadFromFile(const std::string& InFilename)
+{
+	std::ifstream File(InFilename);
+	if (!File)
+	{
+		return false;
+	}
+
+	std::vector<FKey> Keys;
+	std::string Line;
+	while (std::getline(File, Line))
+	{
+		const size_t Comment = Line.find('#');
+		if (Comment != std::string::npos)
+		{
+			Line.resize(Comment);
+		}
+
+		std::istringstream Stream(Line);
+		FKey Key;
+		if (Stream >> Key._position.x >> Key._position.y >> Key._position.z >> Key._yaw >> Key._pitch)
+		{
+			Keys.push_back(Key);
+		}
+	} // end while
+
+	if (Keys.empty())
+	{
+		return false;
+	}
+	_keys.swap(Keys);
+	return true;
+}
+
+void FBenchCameraPath::Evaluate(float InTime, FCamera& OutCamera) const
+{
+	if (_keys.empty())
+	{
+		return;
+	}
+
+	const float t = glm::clamp(InTime, 0.f, 1.f) * static_cast<float>(_keys.size() - 1);
+	const size_t k0 = std::min(static_cast<size_t>(t), _keys.size() - 1);
+	const size_t k1 = std::min(k0 + 1, _keys.size() - 1);
+	const float f = t - static_cast<float>(k0);
+
+	const FKey& A = _keys[k0];
+	const FKey& B = _keys[k1];
+	OutCamera.Init(glm::mix(A._position, B._position, f), glm::vec3(0.f, 1.f, 0.f), glm::mix(A._yaw, B._yaw, f), glm::mix(A._pitch, B._pitch, f));
+}
@@ -0,0 +1,406 @@
+// \brief
+//		headless benchmark: renders the demo scenes along camera paths & reports frame times.
+//
+
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include "SR_Headers.h"
+#include "SR_Trace.h"
+#include "SR_DebugHeatmap.h"
+#include "SR_TileScheduler.h"
+#include "DemoScene.h"
+#include "BenchCameraPath.h"
+
+
+struct FBenchOptions
+{
+	std::vector<std::string>	_scenes;
+	uint32_t	_width = 1024u;
+	uint32_t	_height = 768u;
+	uint32_t	_threads = 0;  // threads incl. the calling one, 0: one per hardware thread, 1: the calling thread only
+	bool		_bMSAA = false;
+	uint32_t	_tile_min = SR_TILE_JOB_MIN_SIZE;
+	uint32_t	_tile_max = SR_TILE_JOB_MAX_SIZE;
+	uint32_t	_frames = 120;
+	uint32_t	_warmup = 5;
+	std::string	_path_file;
+	std::string	_format = "json";
+	std::string	_output;
+	std::string	_trace_file;
+	std::string	_heatmaps_prefix;
+};
+
+struct FBenchFrame
+{
+	double			_microseconds;
+	FSR_Performance	_stats;
+};
+
+struct FBenchRun
+{
+	std::string	_scene;
+	std::vector<FBenchFrame>	_frames;
+};
+
+static void PrintUsage()
+{
+	std::cerr <<
+		"usage: RendererBench [options]\n"
+		"  --scene <list>    comma separated: quad,cubes,sponza,teapot or all (default all)\n"
+		"  --width <n>       render target width (default 1024)\n"
+		"  --height <n>      render target height (default 768)\n"
+		"  --threads <n>     0: one per hardware thread, 1: single threaded (default 0)\n"
+		"  --msaa            enable 4x msaa\n"
+		"  --tile-min <n>    min size of the tile jobs (default 16)\n"
+		"  --tile-max <n>    max size of the tile jobs (default 256), 64 & 64 for a fixed grid\n"
+		"  --frames <n>      measured frames along the path (default 120)\n"
+		"  --warmup <n>      frames rendered before measuring (default 5)\n"
+		"  --path <file>     camera path for all scenes, lines of: x y z yaw pitch\n"
+		"  --format <fmt>    json or csv (default json)\n"
+		"  --output <file>   report file (default stdout)\n"
+		"  --trace <file>    chrome trace of the run, needs SR_ENABLE_TRACE\n"
+		"  --heatmaps <pfx>  heatmaps of the last frame per scene, needs SR_ENABLE_DEBUG_HEATMAPS\n";
+}
+
+static bool ParseOptions(int argc, char* argv[], FBenchOptions& OutOptions)
+{
+	std::string SceneList = "all";
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* Arg = argv[i];
+		const char* Value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		const bool bHasValue = Value != nullptr;
+
+		if (!strcmp(Arg, "--msaa")) { OutOptions._bMSAA = true; continue; }
+		if (!strcmp(Arg, "--help") || !strcmp(Arg, "-h")) { return false; }
+		if (!bHasValue)
+		{
+			std::cerr << "missing value of " << Arg << std::endl;
+			return false;
+		}
+
+		if (!strcmp(Arg, "--scene")) { SceneList = Value; }
+		else if (!strcmp(Arg, "--width")) { OutOptions._width = static_cast<uint32_t>(atoi(Value)); }
+		else if (!strcmp(Arg, "--height")) { OutOptions._height = static_cast<uint32_t>(atoi(Value)); }
+		else if (!strcmp(Arg, "--threads")) { OutOptions._threads = static_cast<uint32_t>(atoi(Value)); }
+		else if (!strcmp(Arg, "--tile-min")) { OutOptions._tile_min = static_cast<uint32_t>(atoi(Value)); }
+		else if (!strcmp(Arg, "--tile-max")) { OutOptions._tile_max = static_cast<uint32_t>(atoi(Value)); }
+		else if (!strcmp(Arg, "--frames")) { OutOptions._frames = static_cast<uint32_t>(atoi(Value)); }
+		else if (!strcmp(Arg, "--warmup")) { OutOptions._warmup = static_cast<uint32_t>(atoi(Value)); }
+		else if (!strcmp(Arg, "--path")) { OutOptions._path_file = Value; }
+		else if (!strcmp(Arg, "--format")) { OutOptions._format = Value; }
+		else if (!strcmp(Arg, "--output")) { OutOptions._output = Value; }
+		else if (!strcmp(Arg, "--trace")) { OutOptions._trace_file = Value; }
+		else if (!strcmp(Arg, "--heatmaps")) { OutOptions._heatmaps_prefix = Value; }
+		else
+		{
+			std::cerr << "unknown option " << Arg << std::endl;
+			return false;
+		}
+		++i;
+	} // end for i
+
+	if (SceneList == "all")
+	{
+		SceneList = "quad,cubes,sponza,teapot";
+	}
+	size_t Start = 0;
+	while (Start <= SceneList.size())
+	{
+		size_t End = SceneList.find(',', Start);
+		if (End == std::string::npos)
+		{
+			End = SceneList.size();
+		}
+		if (End > Start)
+		{
+			OutOptions._scenes.push_back(SceneList.substr(Start, End - Start));
+		}
+		Start = End + 1;
+	} // end while
+
+	if (OutOptions._width == 0 || OutOptions._height == 0 || OutOptions._frames == 0)
+	{
+		std::cerr << "invalid resolution or frame count" << std::endl;
+		return false;
+	}
+	if (OutOptions._format != "json" && OutOptions._format != "csv")
+	{
+		std::cerr << "unknown format " << OutOptions._format << std::endl;
+		return false;
+	}
+	return true;
+}
+
+static std::shared_ptr<FDemoScene> CreateScene(const std::string& InName)
+{
+	if (InName == "quad") return std::make_shared<FDemoScene_Quad>();
+	if (InName == "cubes") return std::make_shared<FDemoScene_Cubes>();
+	if (InName == "sponza") return std::make_shared<FDemoScene_Meshes>();
+	if (InName == "teapot") return std::make_shared<FDemoScene_Teapot>();
+	return nullptr;
+}
+
+static bool RunScene(FSR_Context& ctx, const FBenchOptions& InOptions, const std::string& InScene, FBenchRun& OutRun)
+{
+	std::shared_ptr<FDemoScene> Scene = CreateScene(InScene);
+	FBenchCameraPath Path;
+	if (!Scene || !Path.LoadCanned(InScene))
+	{
+		std::cerr << "unknown scene " << InScene << std::endl;
+		return false;
+	}
+	if (!InOptions._path_file.empty() && !Path.LoadFromFile(InOptions._path_file))
+	{
+		std::cerr << "load camera path " << InOptions._path_file << " failed." << std::endl;
+		return false;
+	}
+
+	FCamera Camera;
+	Scene->Init(Camera);
+
+	OutRun._scene = InScene;
+	OutRun._frames.clear();
+	if (!Scene->IsLoaded())
+	{
+		// no frames: skipped, e.g. sponza without its assets
+		std::cerr << "skip scene " << InScene << ", its assets failed to load." << std::endl;
+		return true;
+	}
+
+	// same target & projection as the real-time viewer
+	ctx.SetRenderTarget(InOptions._width, InOptions._height, 1, InOptions._bMSAA, true);
+	ctx.SetViewport(0, 0, InOptions._width, InOptions._height);
+	ctx.SetCullFaceMode(EFrontFace::FACE_CCW);
+	const glm::mat4 proj = glm::perspective(glm::radians(60.f), static_cast<float>(InOptions._width) / static_cast<float>(InOptions._height), 0.5f, 5000.f);
+	ctx.SetProjectionMatrix(proj);
+
+	// a fixed time step keeps the animated scenes reproducible
+	const float kDeltaSeconds = 1.f / 60.f;
+	const uint32_t TotalFrames = InOptions._warmup + InOptions._frames;
+
+	OutRun._frames.reserve(InOptions._frames);
+	for (uint32_t n = 0; n < TotalFrames; ++n)
+	{
+		const bool bWarmup = n < InOptions._warmup;
+		const float t = bWarmup || InOptions._frames < 2 ? 0.f : static_cast<float>(n - InOptions._warmup) / static_cast<float>(InOptions._frames - 1);
+		Path.Evaluate(t, Camera);
+
+		FPerformanceCounter FrameCounter;
+		ctx._stats->Reset();
+		FrameCounter.StartPerf();
+
+		ctx.BeginFrame();
+		ctx.ClearRenderTarget(glm::vec4(0, 0, 0, 0));
+		Scene->DrawScene(ctx, Camera.GetViewMatrix(), kDeltaSeconds);
+		ctx.EndFrame();
+
+		const double Elapsed = FrameCounter.EndPerf();
+		if (!bWarmup)
+		{
+			OutRun._frames.push_back({ Elapsed, *ctx._stats });
+		}
+	} // end for n
+
+	if (!InOptions._heatmaps_prefix.empty())
+	{
+		if (ctx._heatmaps)
+		{
+			ctx._heatmaps->SaveImages((InOptions._heatmaps_prefix + "_" + InScene).c_str());
+		}
+		else
+		{
+			std::cerr << "heatmaps need SR_ENABLE_DEBUG_HEATMAPS." << std::endl;
+		}
+	}
+
+	return true;
+}
+
+// nearest-rank percentile of the sorted samples
+static double Percentile(const std::vector<double>& InSorted, double InPercent)
+{
+	const size_t Rank = static_cast<size_t>(std::ceil(InPercent / 100.0 * InSorted.size()));
+	return InSorted[std::min(InSorted.size() - 1, Rank > 0 ? Rank - 1 : 0)];
+}
+
+struct FBenchSummary
+{
+	double	_min, _mean, _p50, _p90, _p95, _p99, _max;
+};
+
+static FBenchSummary Summarize(const FBenchRun& InRun)
+{
+	std::vector<double> Milliseconds;
+	double Sum = 0.0;
+	for (const FBenchFrame& Frame : InRun._frames)
+	{
+		Milliseconds.push_back(Frame._microseconds * 0.001);
+		Sum += Frame._microseconds * 0.001;
+	}
+	std::sort(Milliseconds.begin(), Milliseconds.end());
+
+	FBenchSummary Summary;
+	Summary._min = Milliseconds.front();
+	Summary._mean = Sum / Milliseconds.size();
+	Summary._p50 = Percentile(Milliseconds, 50.0);
+	Summary._p90 = Percentile(Milliseconds, 90.0);
+	Summary._p95 = Percentile(Milliseconds, 95.0);
+	Summary._p99 = Percentile(Milliseconds, 99.0);
+	Summary._max = Milliseconds.back();
+	return Summary;
+}
+
+static void WriteJson(std::ostream& Out, const FBenchOptions& InOptions, const std::vector<FBenchRun>& InRuns)
+{
+	Out << std::fixed << std::setprecision(3);
+	Out << "{\n";
+	Out << "  \"width\": " << InOptions._width << ",\n";
+	Out << "  \"height\": " << InOptions._height << ",\n";
+	Out << "  \"threads\": " << InOptions._threads << ",\n";
+	Out << "  \"msaa\": " << (InOptions._bMSAA ? "true" : "false") << ",\n";
+	Out << "  \"tile_sizes\": [" << InOptions._tile_min << ", " << InOptions._tile_max << "],\n";
+	Out << "  \"stage_stats\": " << (SR_ENABLE_PERFORMACE_STAT ? "true" : "false") << ",\n";
+	Out << "  \"runs\": [\n";
+	for (size_t r = 0; r < InRuns.size(); ++r)
+	{
+		const FBenchRun& Run = InRuns[r];
+		const FBenchSummary Summary = Summarize(Run);
+
+		Out << "    {\n";
+		Out << "      \"scene\": \"" << Run._scene << "\",\n";
+		Out << "      \"summary\": { \"frames\": " << Run._frames.size() <<
+			", \"min_ms\": " << Summary._min << ", \"mean_ms\": " << Summary._mean <<
+			", \"p50_ms\": " << Summary._p50 << ", \"p90_ms\": " << Summary._p90 <<
+			", \"p95_ms\": " << Summary._p95 << ", \"p99_ms\": " << Summary._p99 <<
+			", \"max_ms\": " << Summary._max << ", \"fps\": " << 1000.0 / Summary._mean << " },\n";
+		Out << "      \"frames\": [\n";
+		for (size_t n = 0; n < Run._frames.size(); ++n)
+		{
+			const FBenchFrame& Frame = Run._frames[n];
+			Out << "        { \"frame\": " << n << ", \"ms\": " << Frame._microseconds * 0.001;
+#if SR_ENABLE_PERFORMACE_STAT
+			Frame._stats.ForEachStat([&Out](const char* InName, double InValue) {
+				Out << ", \"" << InName << "\": " << InValue;
+			});
+#endif
+			Out << " }" << (n + 1 < Run._frames.size() ? "," : "") << "\n";
+		} // end for n
+		Out << "      ]\n";
+		Out << "    }" << (r + 1 < InRuns.size() ? "," : "") << "\n";
+	} // end for r
+	Out << "  ]\n";
+	Out << "}\n";
+}
+
+static void WriteCsv(std::ostream& Out, const FBenchOptions& InOptions, const std::vector<FBenchRun>& InRuns)
+{
+	Out << std::fixed << std::setprecision(3);
+	// the stage counters only when compiled in, see SR_ENABLE_PERFORMACE_STAT
+	Out << "scene,width,height,threads,msaa,frame,ms";
+#if SR_ENABLE_PERFORMACE_STAT
+	FSR_Performance().ForEachStat([&Out](const char* InName, double) {
+		Out << "," << InName;
+	});
+#endif
+	Out << "\n";
+
+	for (const FBenchRun& Run : InRuns)
+	{
+		for (size_t n = 0; n < Run._frames.size(); ++n)
+		{
+			const FBenchFrame& Frame = Run._frames[n];
+			Out << Run._scene << "," << InOptions._width << "," << InOptions._height << "," << InOptions._threads << "," <<
+				(InOptions._bMSAA ? 1 : 0) << "," << n << "," << Frame._microseconds * 0.001;
+#if SR_ENABLE_PERFORMACE_STAT
+			Frame._stats.ForEachStat([&Out](const char*, double InValue) {
+				Out << "," << InValue;
+			});
+#endif
+			Out << "\n";
+		} // end for n
+	} // end for Run
+}
+
+int main(int argc, char* argv[])
+{
+	FBenchOptions Options;
+	if (!ParseOptions(argc, argv, Options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	FSR_Context ctx;
+	if (Options._threads != 1)
+	{
+		// the calling thread is one of them
+		ctx.EnableMultiThreads(Options._threads > 1 ? Options._threads - 1 : 0);
+	}
+	ctx.SetTileSizeRange(Options._tile_min, Options._tile_max);
+
+	SR_TRACE_THREAD_NAME("Main");
+	if (!Options._trace_file.empty())
+	{
+		FSR_Trace::sharedInstance().Start();
+	}
+
+	std::vector<FBenchRun> Runs;
+	for (const std::string& SceneName : Options._scenes)
+	{
+		FBenchRun Run;
+		if (!RunScene(ctx, Options, SceneName, Run))
+		{
+			FSR_Renderer::TerminateMultiThreads(ctx);
+			return 1;
+		}
+		if (Run._frames.empty())
+		{
+			continue;
+		}
+
+		const FBenchSummary Summary = Summarize(Run);
+		std::cerr << SceneName << ": mean " << Summary._mean << " ms, p99 " << Summary._p99 << " ms" << std::endl;
+		Runs.push_back(std::move(Run));
+	} // end for SceneName
+
+	FSR_Renderer::TerminateMultiThreads(ctx);
+
+	if (!Options._trace_file.empty())
+	{
+		FSR_Trace::sharedInstance().Stop();
+		if (!FSR_Trace::sharedInstance().WriteChromeTrace(Options._trace_file.c_str()))
+		{
+			std::cerr << "write trace " << Options._trace_file << " failed." << std::endl;
+		}
+	}
+
+	std::ofstream File;
+	if (!Options._output.empty())
+	{
+		File.open(Options._output);
+		if (!File)
+		{
+			std::cerr << "open " << Options._output << " failed." << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& Out = Options._output.empty() ? std::cout : File;
+	if (Options._format == "csv")
+	{
+		WriteCsv(Out, Options, Runs);
+	}
+	else
+	{
+		WriteJson(Out, Options, Runs);
+	}
+
+	return 0;
+}
@@ -472,6 +472,46 @@ public:
 #endif
 	}
 
+	virtual void ProcessWide(const FSRPixelShaderContext& InContext, const FSRPixelShaderWideInput& Input, FSRPixelShaderWideOutput& Output) override
+	{
+		FTeapotMaterial* material = dynamic_cast<FTeapotMaterial*>(InContext._material);
+		const float smoothness = material->_smoothness;
+		const float metalness = material->_metalness;
+
+		// uniform over the lanes: H, V & L are constant
+		const glm::vec3 kd = albedo * (1.f - metalness);
+		const glm::vec3 ks = glm::mix(kFb, albedo, metalness);
+		const float HdotV = glm::clamp(glm::dot(halfvector, view_dir), 0.f, 1.f);
+		const glm::vec3 fresnel = fresnelSchlick(HdotV, ks) * ((smoothness + 2.f) / 8.f);
+
+		// N = normalize(M * n)
+		const glm::mat3& M = InContext._mvps._modelview_inv_t;
+		const VectorRegisterWide nx = WideLoad(Input._attributes[0][0]);
+		const VectorRegisterWide ny = WideLoad(Input._attributes[0][1]);
+		const VectorRegisterWide nz = WideLoad(Input._attributes[0][2]);
+		VectorRegisterWide Nx = WideMultiplyAdd(WideSet1(M[2][0]), nz, WideMultiplyAdd(WideSet1(M[1][0]), ny, WideMultiply(WideSet1(M[0][0]), nx)));
+		VectorRegisterWide Ny = WideMultiplyAdd(WideSet1(M[2][1]), nz, WideMultiplyAdd(WideSet1(M[1][1]), ny, WideMultiply(WideSet1(M[0][1]), nx)));
+		VectorRegisterWide Nz = WideMultiplyAdd(WideSet1(M[2][2]), nz, WideMultiplyAdd(WideSet1(M[1][2]), ny, WideMultiply(WideSet1(M[0][2]), nx)));
+		const VectorRegisterWide InvLen = WideDivide(WideSet1(1.f), WideSqrt(WideMultiplyAdd(Nz, Nz, WideMultiplyAdd(Ny, Ny, WideMultiply(Nx, Nx)))));
+		Nx = WideMultiply(Nx, InvLen);
+		Ny = WideMultiply(Ny, InvLen);
+		Nz = WideMultiply(Nz, InvLen);
+
+		const VectorRegisterWide Zero = WideZero();
+		const VectorRegisterWide One = WideSet1(1.f);
+		const VectorRegisterWide NdotH = WideMin(WideMax(WideMultiplyAdd(Nz, WideSet1(halfvector.z), WideMultiplyAdd(Ny, WideSet1(halfvector.y), WideMultiply(Nx, WideSet1(halfvector.x)))), Zero), One);
+		const VectorRegisterWide NdotL = WideMin(WideMax(WideMultiplyAdd(Nz, WideSet1(light_dir.z), WideMultiplyAdd(Ny, WideSet1(light_dir.y), WideMultiply(Nx, WideSet1(light_dir.x)))), Zero), One);
+		const VectorRegisterWide Spec = WidePow(NdotH, WideSet1(smoothness));
+
+		// color = (kd + spec * fresnel) * light_color * NdotL
+		for (uint32_t c = 0; c < 3; ++c)
+		{
+			const VectorRegisterWide R = WideMultiplyAdd(Spec, WideSet1(fresnel[c]), WideSet1(kd[c]));
+			WideStore(WideMultiply(WideMultiply(R, WideSet1(light_color[c])), NdotL), Output._colors[0][c]);
+		}
+		WideStore(One, Output._colors[0][3]);
+	}
+
 	glm::vec3 fresnelSchlick(float HdotV, const glm::vec3& F0) const
 	{
 		return F0 + (glm::vec3(1.f, 1.f, 1.f) - F0) * powf(1.f - HdotV, 5.f);
@@ -2,6 +2,11 @@
 
 cfg_systemversion = "latest" -- "10.0.17763.0"   -- To use the latest version of the SDK available
 
+newoption {
+    trigger = "no-avx2",
+    description = "Build without AVX2, the wide paths fall back to 4-wide SSE"
+}
+
 -- solution
 workspace "AnotherSoftRenderer"
     configurations { "Debug", "Release" }
@@ -9,6 +14,8 @@ workspace "AnotherSoftRenderer"
 
     location "Build"
     defines { "_CRT_SECURE_NO_WARNINGS" }
+    -- aligned new keeps the cache-line padding of the per-thread blocks in std::vector
+    cppdialect "C++17"
     systemversion(cfg_systemversion)
 	
     filter "configurations:Debug"
@@ -20,6 +27,13 @@ workspace "AnotherSoftRenderer"
         defines { "NDEBUG" }
         optimize "On"    
 
+    -- 8-wide SR_SIMD paths (__AVX2__), gcc/clang also need FMA for __FMA__
+    filter "not options:no-avx2"
+        vectorextensions "AVX2"
+
+    filter { "not options:no-avx2", "toolset:gcc or clang" }
+        buildoptions { "-mfma" }
+
     filter "platforms:Win32"
         architecture "x32"
 
@@ -119,4 +133,28 @@ project "RealTimeViewer"
     files {
 		"./RealTimeViewer/Include/*.h",
 		"./RealTimeViewer/Source/*.cc"
-    }
\ No newline at end of file
+    }
+-- project headless benchmark, shares the demo scenes of the realtime viewer
+project "RendererBench"
+    language "C++"
+    kind "ConsoleApp"
+
+	dependson { "Renderer" }
+	links { "Renderer" }
+	
+    includedirs {
+        "./ThirdParty/glm",
+		"./ThirdParty/stb",
+		"./ThirdParty/tinyobjloader",
+		"./Renderer/Include",
+		"./RealTimeViewer/Include",
+		"./RendererBench/Include"
+    }
+	
+    files {
+		"./RealTimeViewer/Include/DemoScene.h",
+		"./RealTimeViewer/Include/Camera.h",
+		"./RealTimeViewer/Source/DemoScene.cc",
+		"./RendererBench/Include/*.h",
+		"./RendererBench/Source/*.cc"
+    }